@@ -1,3 +1,36 @@
 COMPONENT_INCDIRS := src/include
 COMPONENT_SRCDIRS := src
 COMPONENT_DOXYGEN_INPUT := src/include
+
+# Host tool to generate C++ headers and flash tables from CSV data
+CSVGEN_DIR := $(COMPONENT_PATH)/tools/csvgen
+CSVGEN := $(CSVGEN_DIR)/out/Host/release/firmware/app$(TOOL_EXT)
+
+# Generated headers are written here, and may be included directly by the application
+CSVGEN_OUTPUT := $(PROJECT_DIR)/out/csvgen
+COMPONENT_VARS += CSVGEN_HEADERS
+
+# Applications list headers to generate, each with a source file and optional csvgen parameters, e.g.:
+#
+#	CSVGEN_HEADERS := zones
+#	CSVGEN_zones_SOURCE := files/zone1970.tab
+#	CSVGEN_zones_ARGS := name=Zones separator=tab comment=\# headings=codes,coordinates,TZ,comments
+#
+# Generates `zones.h`, so application code just does `#include <zones.h>`.
+ifneq (,$(CSVGEN_HEADERS))
+COMPONENT_INCDIRS += $(CSVGEN_OUTPUT)
+
+$(CSVGEN):
+	$(info Building $@)
+	$(Q) $(MAKE) --no-print-directory -C $(CSVGEN_DIR) SMING_ARCH=Host SMING_RELEASE=1
+
+# $1 -> Header name
+define CsvGenerate
+CUSTOM_TARGETS += $(CSVGEN_OUTPUT)/$1.h
+$(CSVGEN_OUTPUT)/$1.h: $(abspath $(CSVGEN_$1_SOURCE)) | $(CSVGEN)
+	$$(info CSVGEN $$@)
+	$(Q) mkdir -p $$(@D)
+	$(Q) $(CSVGEN) --nonet -- source=$$< output=$$@ $(CSVGEN_$1_ARGS)
+endef
+$(foreach h,$(CSVGEN_HEADERS),$(eval $(call CsvGenerate,$h)))
+endif
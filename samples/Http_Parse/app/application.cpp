@@ -1,5 +1,5 @@
 #include <SmingCore.h>
-#include <CSV/Reader.h>
+#include <CSV/IncrementalParser.h>
 
 #ifndef WIFI_SSID
 #define WIFI_SSID "PleaseEnterSSID" // Put your SSID and password here
@@ -18,8 +18,9 @@ DEFINE_FSTR_LOCAL(ZONE1970_TAB_URL, "http://data.iana.org/time-zones/tzdb/zone19
 #endif
 
 HttpClient downloadClient;
-std::unique_ptr<CSV::Parser> parser;
+std::unique_ptr<CSV::IncrementalParser> parser;
 size_t totalRowSize;
+bool downloadFailed;
 
 bool handleRow(const CStringArray& row)
 {
@@ -28,25 +29,42 @@ bool handleRow(const CStringArray& row)
 	return true;
 }
 
+/*
+ * Data is queued and parsed via the task queue in small slices,
+ * so a large response doesn't block networking or other tasks.
+ */
 int onRequestBody(HttpConnection& client, const char* at, size_t length)
 {
-	size_t offset{0};
-	while(parser->push(at, length, offset)) {
-		handleRow(parser->getRow());
+	if(parser->write(at, length) != length) {
+		return -1;
 	}
+	parser->run();
 	return 0;
 }
 
-int onDownload(HttpConnection& connection, bool success)
+void parseComplete(CSV::IncrementalParser::Status status)
 {
-	while(parser->flush()) {
-		handleRow(parser->getRow());
+	if(status != CSV::IncrementalParser::Status::complete) {
+		Serial.println(_F("Parsing aborted"));
+	} else if(downloadFailed) {
+		Serial.println(_F("Download failed, data is incomplete"));
 	}
-	Serial << _F("Bytes received ") << parser->tell() << _F(", output ") << totalRowSize << endl;
+	Serial << _F("Bytes received ") << parser->getCursor().end << _F(", output ") << totalRowSize << endl;
+	parser.reset();
+}
+
+int onDownload(HttpConnection& connection, bool success)
+{
 	auto status = connection.getResponse()->code;
 	Serial << _F("Got response code: ") << unsigned(status) << " (" << status << _F("), success: ") << success << endl;
 
-	parser.reset();
+	// Remaining data is parsed after we return, result is reported when complete
+	downloadFailed = !success;
+	parser->end();
+	if(!parser->run()) {
+		Serial.println(_F("Failed to schedule parser"));
+		parser.reset();
+	}
 
 	return 0;
 }
@@ -55,11 +73,14 @@ void gotIP(IpAddress ip, IpAddress netmask, IpAddress gateway)
 {
 	Serial << _F("Connected. Got IP: ") << ip << endl;
 
-	parser = std::make_unique<CSV::Parser>(CSV::Parser::Options{
-		.commentChars = "#",
-		.lineLength = 150,
-		.fieldSeparator = '\t',
-	});
+	parser = std::make_unique<CSV::IncrementalParser>(
+		CSV::Parser::Options{
+			.commentChars = "#",
+			.lineLength = 150,
+			.fieldSeparator = '\t',
+		},
+		handleRow, CSV::IncrementalParser::Budget{.bytes = 512});
+	parser->onComplete(parseComplete);
 	auto request = new HttpRequest(String(ZONE1970_TAB_URL));
 	request->onSslInit([](auto& session, auto& request) { session.options.verifyLater = true; });
 	request->onBody(onRequestBody);
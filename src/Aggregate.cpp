@@ -0,0 +1,153 @@
+/****
+ * Aggregate.cpp
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include "include/CSV/Aggregate.h"
+#include "include/CSV/Hash.h"
+#include <algorithm>
+
+namespace CSV
+{
+bool GroupBy::add(const CStringArray& row)
+{
+	auto key = row[keyColumn];
+	if(key == nullptr) {
+		return true;
+	}
+	auto keyLength = strlen(key);
+	auto group = lookup(key, keyLength, fnv1a(key, keyLength), true);
+	if(group == nullptr) {
+		error = true;
+		return false;
+	}
+	group->stats.add(valueColumn >= 0 ? row[valueColumn] : nullptr);
+	return true;
+}
+
+bool GroupBy::add(const Batch& batch)
+{
+	for(unsigned i = 0; i < batch.count(); ++i) {
+		if(!add(batch[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+size_t GroupBy::run(Reader& reader)
+{
+	size_t recordCount{0};
+	while(reader.next()) {
+		if(!add(reader.getRow())) {
+			break;
+		}
+		++recordCount;
+	}
+	return recordCount;
+}
+
+bool GroupBy::merge(const GroupBy& other)
+{
+	for(auto& g : other.groups) {
+		auto group = lookup(g.key, g.keyLength, g.hash, true);
+		if(group == nullptr) {
+			error = true;
+			return false;
+		}
+		group->stats.merge(g.stats);
+	}
+	return true;
+}
+
+const GroupBy::Group* GroupBy::find(const char* key) const
+{
+	if(key == nullptr) {
+		return nullptr;
+	}
+	auto keyLength = strlen(key);
+	return const_cast<GroupBy*>(this)->lookup(key, keyLength, fnv1a(key, keyLength), false);
+}
+
+GroupBy::Group* GroupBy::lookup(const char* key, size_t keyLength, uint32_t hash, bool create)
+{
+	auto i = index.find(hash, [&](unsigned i) {
+		auto& group = groups[i];
+		return group.hash == hash && group.keyLength == keyLength && memcmp(group.key, key, keyLength) == 0;
+	});
+	if(i >= 0) {
+		return &groups[i];
+	}
+
+	if(!create || keyLength > UINT16_MAX) {
+		return nullptr;
+	}
+
+	auto keyCopy = static_cast<char*>(arena.allocate(keyLength + 1, 1));
+	if(keyCopy == nullptr) {
+		return nullptr;
+	}
+	memcpy(keyCopy, key, keyLength);
+	keyCopy[keyLength] = '\0';
+
+	if(!append(groups, Group{keyCopy, uint16_t(keyLength), hash, {}})) {
+		return nullptr;
+	}
+	if(!index.add(hash, groups.size() - 1, [this](unsigned i) { return groups[i].hash; })) {
+		groups.pop_back();
+		return nullptr;
+	}
+	return &groups.back();
+}
+
+std::vector<const GroupBy::Group*> GroupBy::top(unsigned k, Order order) const
+{
+	auto value = [order](const Group* g) -> double {
+		switch(order) {
+		case Order::sum:
+			return g->stats.sum;
+		case Order::min:
+			return g->stats.min;
+		case Order::max:
+			return g->stats.max;
+		case Order::count:
+		default:
+			return g->stats.count;
+		}
+	};
+
+	std::vector<const Group*> list;
+	list.reserve(groups.size());
+	for(auto& g : groups) {
+		list.push_back(&g);
+	}
+	k = std::min(size_t(k), list.size());
+	std::partial_sort(list.begin(), list.begin() + k, list.end(),
+					  [&](const Group* g1, const Group* g2) { return value(g1) > value(g2); });
+	list.resize(k);
+	return list;
+}
+
+void GroupBy::clear()
+{
+	groups.clear();
+	index.clear();
+	arena.clear();
+	error = false;
+}
+
+} // namespace CSV
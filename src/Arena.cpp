@@ -0,0 +1,133 @@
+/****
+ * Arena.cpp
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include "include/CSV/Arena.h"
+#include <debug_progmem.h>
+#include <new>
+
+namespace CSV
+{
+const char* ArenaRow::operator[](unsigned index) const
+{
+	if(index >= valueCount) {
+		return nullptr;
+	}
+	auto ptr = data;
+	while(index-- != 0) {
+		ptr += strlen(ptr) + 1;
+	}
+	return ptr;
+}
+
+Arena::Arena(void* buffer, size_t size, size_t blockSize) : blockSize(blockSize)
+{
+	// Block header requires alignment, which a byte buffer may not have
+	auto addr = uintptr_t(buffer);
+	auto skip = ((addr + alignof(Block) - 1) & ~uintptr_t(alignof(Block) - 1)) - addr;
+	if(buffer == nullptr || size <= skip + sizeof(Block)) {
+		return;
+	}
+	head = new(reinterpret_cast<void*>(addr + skip)) Block{nullptr, size - skip - sizeof(Block), 0, false};
+	current = head;
+	capacity = head->size;
+}
+
+void* Arena::allocate(size_t size, size_t align)
+{
+	auto block = current;
+	while(block != nullptr) {
+		auto base = uintptr_t(block->data());
+		auto offset = ((base + block->used + align - 1) & ~(align - 1)) - base;
+		if(offset + size <= block->size) {
+			// Include alignment padding
+			used += offset + size - block->used;
+			block->used = offset + size;
+			current = block;
+			return block->data() + offset;
+		}
+		// Blocks retained by reset() may follow
+		block = block->next;
+	}
+
+	block = addBlock(size + align);
+	if(block == nullptr) {
+		return nullptr;
+	}
+	current = block;
+	return allocate(size, align);
+}
+
+Arena::Block* Arena::addBlock(size_t minSize)
+{
+	if(blockSize == 0) {
+		return nullptr;
+	}
+	auto size = std::max(blockSize, minSize);
+	auto mem = malloc(sizeof(Block) + size);
+	if(mem == nullptr) {
+		debug_e("[CSV] Arena out of memory %u", size);
+		return nullptr;
+	}
+	auto block = new(mem) Block{nullptr, size, 0, true};
+
+	// Append to list so blocks are filled in order
+	if(head == nullptr) {
+		head = block;
+	} else {
+		auto tail = current ?: head;
+		while(tail->next != nullptr) {
+			tail = tail->next;
+		}
+		tail->next = block;
+	}
+	capacity += size;
+	return block;
+}
+
+void Arena::reset()
+{
+	for(auto block = head; block != nullptr; block = block->next) {
+		block->used = 0;
+	}
+	current = head;
+	used = 0;
+}
+
+void Arena::clear()
+{
+	Block* fixed{nullptr};
+	auto block = head;
+	while(block != nullptr) {
+		auto next = block->next;
+		if(block->heap) {
+			free(block);
+		} else {
+			fixed = block;
+			fixed->next = nullptr;
+			fixed->used = 0;
+		}
+		block = next;
+	}
+	head = fixed;
+	current = fixed;
+	used = 0;
+	capacity = fixed ? fixed->size : 0;
+}
+
+} // namespace CSV
@@ -0,0 +1,102 @@
+/****
+ * AsyncParser.cpp
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include "include/CSV/AsyncParser.h"
+
+#if defined(ARCH_HOST) && defined(__cpp_impl_coroutine)
+
+namespace CSV
+{
+void AsyncParser::write(const char* data, size_t length)
+{
+	this->data = data;
+	this->length = length;
+	offset = 0;
+
+	resume();
+
+	if(offset < length) {
+		// Consumer isn't waiting so retain unparsed data
+		if(pendingOffset != 0) {
+			pending.remove(0, pendingOffset);
+			pendingOffset = 0;
+		}
+		pending.concat(data + offset, length - offset);
+	}
+
+	this->data = nullptr;
+	this->length = 0;
+	offset = 0;
+}
+
+void AsyncParser::end()
+{
+	finished = true;
+	resume();
+}
+
+void AsyncParser::resume()
+{
+	// Consumer runs until it next waits for data, or completes
+	while(consumer && fetch()) {
+		std::exchange(consumer, nullptr).resume();
+	}
+}
+
+/*
+ * Returns true if result is available, false if more data is required
+ */
+bool AsyncParser::fetch()
+{
+	if(done) {
+		result = nullptr;
+		return true;
+	}
+
+	if(pendingOffset < pending.length()) {
+		if(push(pending.c_str(), pending.length(), pendingOffset)) {
+			result = &getRow();
+			return true;
+		}
+		pending = nullptr;
+		pendingOffset = 0;
+	}
+
+	if(offset < length && push(data, length, offset)) {
+		result = &getRow();
+		return true;
+	}
+
+	if(!finished) {
+		return false;
+	}
+
+	if(flush()) {
+		result = &getRow();
+		return true;
+	}
+
+	done = true;
+	result = nullptr;
+	return true;
+}
+
+} // namespace CSV
+
+#endif // ARCH_HOST && __cpp_impl_coroutine
@@ -0,0 +1,117 @@
+/****
+ * CachedStream.cpp
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include "include/CSV/CachedStream.h"
+#include <algorithm>
+
+namespace CSV
+{
+CachedStream::CachedStream(IDataSourceStream* source, unsigned blockCount, uint16_t blockSize)
+	: source(source), blocks(new Block[std::max(blockCount, 1U)]), blockCount(std::max(blockCount, 1U)),
+	  blockSize(std::max(blockSize, uint16_t(16)))
+{
+	if(source) {
+		pos = source->seekFrom(0, SeekOrigin::Current);
+		size = source->seekFrom(0, SeekOrigin::End);
+	} else {
+		size = -1;
+	}
+	if(pos < 0 || size < 0) {
+		pos = 0;
+		size = -1;
+	}
+}
+
+uint16_t CachedStream::readMemoryBlock(char* data, int bufSize)
+{
+	if(bufSize <= 0 || pos >= size) {
+		return 0;
+	}
+	auto block = getBlock(pos / blockSize);
+	if(block == nullptr) {
+		return 0;
+	}
+	unsigned offset = pos % blockSize;
+	if(offset >= block->length) {
+		return 0;
+	}
+	auto len = std::min(unsigned(bufSize), block->length - offset);
+	memcpy(data, &block->data[offset], len);
+	return len;
+}
+
+int CachedStream::seekFrom(int offset, SeekOrigin origin)
+{
+	if(size < 0) {
+		return -1;
+	}
+	int newPos;
+	switch(origin) {
+	case SeekOrigin::Start:
+		newPos = offset;
+		break;
+	case SeekOrigin::Current:
+		newPos = pos + offset;
+		break;
+	case SeekOrigin::End:
+		newPos = size + offset;
+		break;
+	default:
+		return -1;
+	}
+	if(newPos < 0 || newPos > size) {
+		return -1;
+	}
+	pos = newPos;
+	return pos;
+}
+
+CachedStream::Block* CachedStream::getBlock(int index)
+{
+	++useCount;
+	Block* lru{&blocks[0]};
+	for(unsigned i = 0; i < blockCount; ++i) {
+		auto& block = blocks[i];
+		if(block.index == index) {
+			++hitCount;
+			block.lastUse = useCount;
+			return &block;
+		}
+		if(block.lastUse < lru->lastUse) {
+			lru = &block;
+		}
+	}
+
+	++missCount;
+	auto& block = *lru;
+	block.index = -1;
+	if(!block.data) {
+		block.data.reset(new char[blockSize]);
+	}
+	int blockStart = index * blockSize;
+	if(source->seekFrom(blockStart, SeekOrigin::Start) != blockStart) {
+		return nullptr;
+	}
+	block.length = source->readBytes(block.data.get(), blockSize);
+	block.index = index;
+	block.lastUse = useCount;
+	return &block;
+}
+
+} // namespace CSV
@@ -0,0 +1,369 @@
+/****
+ * CodeGenerator.cpp
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include "include/CSV/CodeGenerator.h"
+#include <debug_progmem.h>
+#include <cinttypes>
+#include <cmath>
+#include <cctype>
+#include <algorithm>
+
+namespace
+{
+using namespace CSV;
+
+void writeString(Print& out, const char* value)
+{
+	out.print('"');
+	for(; *value; ++value) {
+		uint8_t c = *value;
+		switch(c) {
+		case '"':
+			out.print("\\\"");
+			break;
+		case '\\':
+			out.print("\\\\");
+			break;
+		case '\n':
+			out.print("\\n");
+			break;
+		case '\r':
+			out.print("\\r");
+			break;
+		case '\t':
+			out.print("\\t");
+			break;
+		default:
+			if(isprint(c)) {
+				out.print(char(c));
+			} else {
+				// Always use 3 octal digits so following characters aren't consumed
+				char buf[5];
+				snprintf(buf, sizeof(buf), "\\%03o", c);
+				out.print(buf);
+			}
+		}
+	}
+	out.print('"');
+}
+
+const char* getTypeName(ValueType type, bool wide)
+{
+	switch(type) {
+	case ValueType::integer:
+		return wide ? "int64_t" : "int32_t";
+	case ValueType::number:
+		return "double";
+	default:
+		return "const char*";
+	}
+}
+
+bool isIdentifier(const char* name)
+{
+	if(name == nullptr || *name == '\0') {
+		return false;
+	}
+	// Allow qualified names, e.g. "Data::Zones"
+	bool start{true};
+	for(; *name; ++name) {
+		if(start && isdigit(uint8_t(*name))) {
+			return false;
+		}
+		if(name[0] == ':' && name[1] == ':' && !start) {
+			++name;
+			start = true;
+			continue;
+		}
+		if(!isalnum(uint8_t(*name)) && *name != '_') {
+			return false;
+		}
+		start = false;
+	}
+	return !start;
+}
+
+bool isKeyword(const char* name)
+{
+	static const char* const keywords[]{
+		"alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break", "case", "catch",
+		"char", "char16_t", "char32_t", "char8_t", "class", "co_await", "co_return", "co_yield", "compl", "concept",
+		"const", "const_cast", "consteval", "constexpr", "constinit", "continue", "decltype", "default", "delete",
+		"do", "double", "dynamic_cast", "else", "enum", "explicit", "export", "extern", "false", "float", "for",
+		"friend", "goto", "if", "inline", "int", "long", "mutable", "namespace", "new", "noexcept", "not", "not_eq",
+		"nullptr", "operator", "or", "or_eq", "private", "protected", "public", "register", "reinterpret_cast",
+		"requires", "return", "short", "signed", "sizeof", "static", "static_assert", "static_cast", "struct",
+		"switch", "template", "this", "thread_local", "throw", "true", "try", "typedef", "typeid", "typename",
+		"union", "unsigned", "using", "virtual", "void", "volatile", "wchar_t", "while", "xor", "xor_eq"};
+	for(auto keyword : keywords) {
+		if(strcmp(name, keyword) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+ * Identifiers are also used to name `findBy...` functions, with the first character in upper case
+ */
+bool isSameIdentifier(const String& id1, const String& id2)
+{
+	return id1.length() == id2.length() && toupper(id1[0]) == toupper(id2[0]) &&
+		   strcmp(id1.c_str() + 1, id2.c_str() + 1) == 0;
+}
+
+} // namespace
+
+namespace CSV
+{
+CodeGenerator::CodeGenerator(Reader& reader, const std::vector<ValueType>& types) : reader(reader)
+{
+	scan(types);
+}
+
+String CodeGenerator::makeIdentifier(const char* name)
+{
+	String id;
+	if(name == nullptr || !isalpha(uint8_t(*name))) {
+		id += '_';
+	}
+	if(name != nullptr) {
+		for(; *name; ++name) {
+			id += isalnum(uint8_t(*name)) ? *name : '_';
+		}
+	}
+	if(isKeyword(id.c_str())) {
+		id += '_';
+	}
+	return id;
+}
+
+void CodeGenerator::scan(const std::vector<ValueType>& types)
+{
+	auto& headings = reader.getHeadings();
+	unsigned columnCount = headings.count();
+	columns.clear();
+	columns.reserve(columnCount);
+	for(unsigned col = 0; col < columnCount; ++col) {
+		auto id = makeIdentifier(headings[col]);
+		// Headings such as "first name" and "first-name" give the same identifier, so make unique
+		auto isUsed = [&](const String& id) {
+			return std::any_of(columns.begin(), columns.end(),
+							   [&](const Column& c) { return isSameIdentifier(c.identifier, id); });
+		};
+		if(isUsed(id)) {
+			String base = id;
+			for(unsigned n = 2; isUsed(id); ++n) {
+				id = base;
+				id += '_';
+				id += n;
+			}
+		}
+		columns.push_back({id, ValueType::empty, false});
+	}
+
+	// Infer types and integer ranges from data
+	reader.reset();
+	while(reader.next()) {
+		auto& row = reader.getRow();
+		for(unsigned col = 0; col < columnCount; ++col) {
+			auto& column = columns[col];
+			auto value = row[col];
+			auto type = getValueType(value);
+			column.type = combine(column.type, type);
+			int64_t n;
+			if(type == ValueType::integer && parseInteger(value, n) && (n < INT32_MIN || n > INT32_MAX)) {
+				column.wide = true;
+			}
+		}
+	}
+	reader.reset();
+
+	for(unsigned col = 0; col < columnCount && col < types.size(); ++col) {
+		if(types[col] != ValueType::empty) {
+			columns[col].type = types[col];
+		}
+	}
+	for(auto& column : columns) {
+		if(column.type == ValueType::empty) {
+			column.type = ValueType::text;
+		}
+	}
+}
+
+bool CodeGenerator::writeValue(Print& out, const Column& column, const char* value)
+{
+	if(column.type == ValueType::text) {
+		writeString(out, value ?: "");
+		return true;
+	}
+
+	if(getValueType(value) == ValueType::empty) {
+		out.print('0');
+		return true;
+	}
+
+	char buf[32];
+	if(column.type == ValueType::integer) {
+		int64_t n;
+		if(!parseInteger(value, n)) {
+			return false;
+		}
+		if(n == INT64_MIN) {
+			out.print("INT64_MIN");
+			return true;
+		}
+		snprintf(buf, sizeof(buf), "%" PRId64, n);
+	} else {
+		double d;
+		if(!parseNumber(value, d) || !std::isfinite(d)) {
+			return false;
+		}
+		// Use shortest representation which converts back exactly
+		for(int precision = 15; precision <= 17; ++precision) {
+			snprintf(buf, sizeof(buf), "%.*g", precision, d);
+			if(strtod(buf, nullptr) == d) {
+				break;
+			}
+		}
+		// Ensure value is a floating-point literal
+		if(strpbrk(buf, ".e") == nullptr) {
+			strcat(buf, ".0");
+		}
+	}
+	out.print(buf);
+	return true;
+}
+
+bool CodeGenerator::generate(Print& out, const char* name)
+{
+	if(columns.empty() || !isIdentifier(name)) {
+		return false;
+	}
+
+	out.print("// Generated by CSV::CodeGenerator, do not edit\n");
+	out.print('\n');
+	out.print("#pragma once\n");
+	out.print('\n');
+	out.print("#include <cstdint>\n");
+	out.print("#include <cstddef>\n");
+	out.print("#include <string_view>\n");
+	out.print('\n');
+	out.print("namespace ");
+	out.print(name);
+	out.print('\n');
+	out.print("{\n");
+
+	out.print("struct Record {\n");
+	for(auto& column : columns) {
+		out.print('\t');
+		out.print(getTypeName(column.type, column.wide));
+		out.print(' ');
+		out.print(column.identifier);
+		out.print(";\n");
+	}
+	out.print("};\n");
+	out.print('\n');
+
+	auto& headings = reader.getHeadings();
+	out.print("constexpr const char* columnNames[]{\n");
+	for(unsigned col = 0; col < columns.size(); ++col) {
+		out.print('\t');
+		writeString(out, headings[col] ?: "");
+		out.print(",\n");
+	}
+	out.print("};\n");
+	out.print('\n');
+
+	bool ok{true};
+	out.print("constexpr Record records[]{\n");
+	reader.reset();
+	while(ok && reader.next()) {
+		auto& row = reader.getRow();
+		out.print("\t{");
+		for(unsigned col = 0; col < columns.size(); ++col) {
+			if(col != 0) {
+				out.print(", ");
+			}
+			ok = writeValue(out, columns[col], row[col]);
+			if(!ok) {
+				debug_e("[CSV] Value '%s' invalid for column '%s'", row[col], headings[col]);
+				break;
+			}
+		}
+		out.print("},\n");
+	}
+	reader.reset();
+	out.print("};\n");
+	out.print('\n');
+
+	out.print("constexpr size_t recordCount{sizeof(records) / sizeof(records[0])};\n");
+	out.print('\n');
+
+	out.print("/**\n");
+	out.print(" * @brief Find first record with a matching value\n");
+	out.print(" * @retval const Record* nullptr if not found\n");
+	out.print(" */\n");
+	out.print("template <typename T, typename V> constexpr const Record* find(T Record::*field, const V& value)\n");
+	out.print("{\n");
+	out.print("\tfor(auto& rec : records) {\n");
+	out.print("\t\tif(rec.*field == value) {\n");
+	out.print("\t\t\treturn &rec;\n");
+	out.print("\t\t}\n");
+	out.print("\t}\n");
+	out.print("\treturn nullptr;\n");
+	out.print("}\n");
+
+	for(auto& column : columns) {
+		const char* argType;
+		switch(column.type) {
+		case ValueType::text:
+			argType = "std::string_view";
+			break;
+		case ValueType::integer:
+			argType = getTypeName(column.type, column.wide);
+			break;
+		default:
+			// Exact comparison of floating-point values isn't useful
+			continue;
+		}
+		out.print('\n');
+		String fn = column.identifier;
+		fn[0] = toupper(fn[0]);
+		out.print("constexpr const Record* findBy");
+		out.print(fn);
+		out.print('(');
+		out.print(argType);
+		out.print(" value)\n");
+		out.print("{\n");
+		out.print("\treturn find(&Record::");
+		out.print(column.identifier);
+		out.print(", value);\n");
+		out.print("}\n");
+	}
+
+	out.print('\n');
+	out.print("} // namespace ");
+	out.print(name);
+	out.print('\n');
+
+	return ok;
+}
+
+} // namespace CSV
@@ -0,0 +1,575 @@
+/****
+ * ColumnFile.cpp
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include "include/CSV/ColumnFile.h"
+#include "include/CSV/StringPool.h"
+#include <vector>
+
+namespace CSV
+{
+namespace
+{
+constexpr size_t align4(size_t n)
+{
+	return (n + 3) & ~3;
+}
+
+constexpr size_t align8(size_t n)
+{
+	return (n + 7) & ~7;
+}
+
+constexpr size_t getBitmapSize(size_t count)
+{
+	return align8((count + 7) / 8);
+}
+
+/*
+ * Track output position and errors
+ */
+class Output
+{
+public:
+	Output(Print& out) : out(out)
+	{
+	}
+
+	bool write(const void* data, size_t length)
+	{
+		if(ok && length != 0) {
+			ok = out.write(static_cast<const uint8_t*>(data), length) == length;
+		}
+		pos += length;
+		return ok;
+	}
+
+	template <typename T> bool write(const std::vector<T>& values)
+	{
+		return write(values.data(), values.size() * sizeof(T));
+	}
+
+	bool pad(size_t align = 8)
+	{
+		static const uint8_t zeros[8]{};
+		return write(zeros, ((pos + align - 1) & ~(align - 1)) - pos);
+	}
+
+	uint32_t pos{0};
+	bool ok{true};
+
+private:
+	Print& out;
+};
+
+/*
+ * Column values for a chunk are held as consecutive NUL-terminated strings
+ */
+template <typename F> void forEachValue(const String& values, F callback)
+{
+	auto ptr = values.c_str();
+	auto end = ptr + values.length();
+	for(unsigned i = 0; ptr < end; ++i) {
+		auto len = strlen(ptr);
+		callback(i, ptr, len);
+		ptr += len + 1;
+	}
+}
+
+bool parseValue(const char* str, int64_t& value)
+{
+	return parseInteger(str, value);
+}
+
+bool parseValue(const char* str, double& value)
+{
+	return parseNumber(str, value);
+}
+
+template <typename T>
+void writeNumeric(Output& output, ColumnFile::ChunkHeader& hdr, const String& values, bool hasEmpty)
+{
+	std::vector<uint8_t> validity;
+	if(hasEmpty) {
+		hdr.flags |= ColumnFile::flagValidity;
+		validity.resize(getBitmapSize(hdr.count));
+	}
+	std::vector<T> numbers(hdr.count);
+	forEachValue(values, [&](unsigned i, const char* value, size_t) {
+		T n;
+		if(parseValue(value, n)) {
+			numbers[i] = n;
+			if(hasEmpty) {
+				validity[i / 8] |= 1 << (i % 8);
+			}
+		}
+	});
+	hdr.size = validity.size() + numbers.size() * sizeof(T);
+	output.write(&hdr, sizeof(hdr));
+	output.write(validity);
+	output.write(numbers);
+}
+
+/*
+ * Dictionary encoding is used if there are few distinct values
+ */
+bool writeDictionary(Output& output, ColumnFile::ChunkHeader& hdr, const String& values, StringPool& pool)
+{
+	pool.clear();
+	std::vector<uint16_t> ids(hdr.count);
+	bool ok{true};
+	forEachValue(values, [&](unsigned i, const char* value, size_t length) {
+		auto id = ok ? pool.add(value, length) : StringPool::none;
+		ok = (id != StringPool::none);
+		ids[i] = id - 1;
+	});
+	if(!ok) {
+		return false;
+	}
+
+	unsigned dictCount = pool.count();
+	size_t codeWidth = (dictCount <= 0x100) ? 1 : 2;
+	size_t textSize{0};
+	for(unsigned id = 1; id <= dictCount; ++id) {
+		textSize += pool.getLength(id) + 1;
+	}
+	size_t plainSize = (hdr.count + 1) * sizeof(uint32_t) + values.length();
+	size_t dictSize = align4(hdr.count * codeWidth) + (dictCount + 1) * sizeof(uint32_t) + textSize;
+	if(dictSize >= plainSize) {
+		return false;
+	}
+
+	hdr.encoding = (codeWidth == 1) ? ColumnFile::Encoding::dictionary8 : ColumnFile::Encoding::dictionary16;
+	hdr.size = dictSize;
+	hdr.dictCount = dictCount;
+	output.write(&hdr, sizeof(hdr));
+	if(codeWidth == 1) {
+		std::vector<uint8_t> codes(ids.begin(), ids.end());
+		output.write(codes);
+	} else {
+		output.write(ids);
+	}
+	output.pad(4);
+	std::vector<uint32_t> offsets;
+	offsets.reserve(dictCount + 1);
+	uint32_t offset{0};
+	for(unsigned id = 1; id <= dictCount; ++id) {
+		offsets.push_back(offset);
+		offset += pool.getLength(id) + 1;
+	}
+	offsets.push_back(offset);
+	output.write(offsets);
+	for(unsigned id = 1; id <= dictCount; ++id) {
+		output.write(pool[id], pool.getLength(id) + 1);
+	}
+	return true;
+}
+
+void writeText(Output& output, ColumnFile::ChunkHeader& hdr, const String& values)
+{
+	std::vector<uint32_t> offsets;
+	offsets.reserve(hdr.count + 1);
+	forEachValue(values, [&](unsigned, const char* value, size_t) {
+		offsets.push_back(value - values.c_str());
+	});
+	offsets.push_back(values.length());
+	hdr.encoding = ColumnFile::Encoding::text;
+	hdr.size = offsets.size() * sizeof(uint32_t) + values.length();
+	output.write(&hdr, sizeof(hdr));
+	output.write(offsets);
+	output.write(values.c_str(), values.length());
+}
+
+/*
+ * Write one column of a chunk, returning the type of its values
+ */
+ValueType writeColumn(Output& output, const String& values, unsigned count, const ColumnFile::Settings& settings,
+					  StringPool& pool)
+{
+	ValueType type{ValueType::empty};
+	bool hasEmpty{false};
+	forEachValue(values, [&](unsigned, const char* value, size_t) {
+		auto t = getValueType(value);
+		if(t == ValueType::empty) {
+			hasEmpty = true;
+		} else {
+			type = combine(type, t);
+		}
+	});
+
+	ColumnFile::ChunkHeader hdr{};
+	hdr.count = count;
+	switch(type) {
+	case ValueType::empty:
+		hdr.encoding = ColumnFile::Encoding::empty;
+		output.write(&hdr, sizeof(hdr));
+		break;
+	case ValueType::integer:
+		hdr.encoding = ColumnFile::Encoding::integer;
+		writeNumeric<int64_t>(output, hdr, values, hasEmpty);
+		break;
+	case ValueType::number:
+		hdr.encoding = ColumnFile::Encoding::number;
+		writeNumeric<double>(output, hdr, values, hasEmpty);
+		break;
+	case ValueType::text:
+	default:
+		if(!settings.dictionary || !writeDictionary(output, hdr, values, pool)) {
+			writeText(output, hdr, values);
+		}
+	}
+	output.pad();
+	return type;
+}
+
+/*
+ * Get size of chunk content as determined by its header, SIZE_MAX if invalid
+ */
+size_t getContentSize(const ColumnFile::ChunkHeader& hdr)
+{
+	auto content = reinterpret_cast<const uint8_t*>(&hdr + 1);
+	size_t size{0};
+	unsigned textCount{0};
+	switch(hdr.encoding) {
+	case ColumnFile::Encoding::empty:
+		return 0;
+	case ColumnFile::Encoding::integer:
+	case ColumnFile::Encoding::number:
+		if(hdr.flags & ColumnFile::flagValidity) {
+			size = getBitmapSize(hdr.count);
+		}
+		return size + size_t(hdr.count) * 8;
+	case ColumnFile::Encoding::text:
+		textCount = hdr.count;
+		break;
+	case ColumnFile::Encoding::dictionary8:
+		size = align4(hdr.count);
+		textCount = hdr.dictCount;
+		break;
+	case ColumnFile::Encoding::dictionary16:
+		size = align4(size_t(hdr.count) * 2);
+		textCount = hdr.dictCount;
+		break;
+	default:
+		return SIZE_MAX;
+	}
+	// Offsets must be present before last one can be read
+	auto offsets = reinterpret_cast<const uint32_t*>(content + size);
+	size += (size_t(textCount) + 1) * sizeof(uint32_t);
+	if(size > hdr.size) {
+		return SIZE_MAX;
+	}
+	return size + offsets[textCount];
+}
+
+} // namespace
+
+/* Chunk */
+
+ColumnFile::Chunk::Chunk(const ChunkHeader* header) : header(header)
+{
+	auto content = reinterpret_cast<const uint8_t*>(header + 1);
+	switch(header->encoding) {
+	case Encoding::integer:
+	case Encoding::number:
+		if(header->flags & flagValidity) {
+			validity = content;
+			content += getBitmapSize(header->count);
+		}
+		values = content;
+		break;
+	case Encoding::text:
+		offsets = reinterpret_cast<const uint32_t*>(content);
+		text = reinterpret_cast<const char*>(offsets + header->count + 1);
+		break;
+	case Encoding::dictionary8:
+	case Encoding::dictionary16:
+		values = content;
+		content += align4(header->count * ((header->encoding == Encoding::dictionary8) ? 1 : 2));
+		offsets = reinterpret_cast<const uint32_t*>(content);
+		text = reinterpret_cast<const char*>(offsets + header->dictCount + 1);
+		break;
+	case Encoding::empty:
+	default:
+		break;
+	}
+}
+
+bool ColumnFile::Chunk::isEmpty(unsigned index) const
+{
+	if(index >= count()) {
+		return true;
+	}
+	switch(header->encoding) {
+	case Encoding::integer:
+	case Encoding::number:
+		return validity && !(validity[index / 8] & (1 << (index % 8)));
+	case Encoding::text:
+	case Encoding::dictionary8:
+	case Encoding::dictionary16:
+		return *getText(index) == '\0';
+	case Encoding::empty:
+	default:
+		return true;
+	}
+}
+
+int64_t ColumnFile::Chunk::getInteger(unsigned index) const
+{
+	if(index >= count()) {
+		return 0;
+	}
+	switch(header->encoding) {
+	case Encoding::integer:
+		return getIntegers()[index];
+	case Encoding::number:
+		return getNumbers()[index];
+	default:
+		return 0;
+	}
+}
+
+double ColumnFile::Chunk::getNumber(unsigned index) const
+{
+	if(index >= count()) {
+		return 0;
+	}
+	switch(header->encoding) {
+	case Encoding::integer:
+		return getIntegers()[index];
+	case Encoding::number:
+		return getNumbers()[index];
+	default:
+		return 0;
+	}
+}
+
+const char* ColumnFile::Chunk::getText(unsigned index) const
+{
+	if(index >= count()) {
+		return nullptr;
+	}
+	switch(header->encoding) {
+	case Encoding::text:
+		return text + offsets[index];
+	case Encoding::dictionary8:
+	case Encoding::dictionary16:
+		return getDictionaryValue(getCode(index));
+	default:
+		return nullptr;
+	}
+}
+
+unsigned ColumnFile::Chunk::getCode(unsigned index) const
+{
+	if(index >= count()) {
+		return getDictionarySize();
+	}
+	switch(header->encoding) {
+	case Encoding::dictionary8:
+		return values[index];
+	case Encoding::dictionary16:
+		return reinterpret_cast<const uint16_t*>(values)[index];
+	default:
+		return 0;
+	}
+}
+
+/* ColumnFile */
+
+ColumnFile::ColumnFile(const void* data, size_t length) : data(static_cast<const uint8_t*>(data))
+{
+	if(data == nullptr || uintptr_t(data) % 8 != 0 || length % 8 != 0 || length < sizeof(Header) + sizeof(Trailer)) {
+		return;
+	}
+	auto hdr = static_cast<const Header*>(data);
+	if(hdr->magic != magic || hdr->version != version) {
+		return;
+	}
+	auto trl = reinterpret_cast<const Trailer*>(this->data + length - sizeof(Trailer));
+	if(trl->magic != magic) {
+		return;
+	}
+	size_t headingsEnd = align8(sizeof(Header) + hdr->headingsSize);
+	uint64_t footerSize =
+		align8(hdr->columnCount) + uint64_t(trl->chunkCount) * (1 + hdr->columnCount) * sizeof(uint32_t);
+	if(trl->footerOffset % 8 != 0 || trl->footerOffset < headingsEnd || trl->footerOffset > length - sizeof(Trailer) ||
+	   footerSize > length - sizeof(Trailer) - trl->footerOffset) {
+		return;
+	}
+	if(hdr->headingsSize != 0 && this->data[sizeof(Header) + hdr->headingsSize - 1] != '\0') {
+		return;
+	}
+
+	header = hdr;
+	trailer = trl;
+	types = this->data + trl->footerOffset;
+	chunkStarts = reinterpret_cast<const uint32_t*>(types + align8(hdr->columnCount));
+	chunkOffsets = chunkStarts + trl->chunkCount;
+}
+
+const char* ColumnFile::getHeading(unsigned column) const
+{
+	if(column >= getColumnCount()) {
+		return nullptr;
+	}
+	auto ptr = reinterpret_cast<const char*>(header + 1);
+	auto end = ptr + header->headingsSize;
+	for(; column != 0 && ptr < end; --column) {
+		ptr += strlen(ptr) + 1;
+	}
+	return (ptr < end) ? ptr : nullptr;
+}
+
+int ColumnFile::getColumn(const char* name) const
+{
+	if(name == nullptr) {
+		return -1;
+	}
+	for(unsigned col = 0; col < getColumnCount(); ++col) {
+		auto heading = getHeading(col);
+		if(heading && strcmp(heading, name) == 0) {
+			return col;
+		}
+	}
+	return -1;
+}
+
+ColumnFile::Chunk ColumnFile::getChunk(unsigned chunk, unsigned column) const
+{
+	if(chunk >= getChunkCount() || column >= getColumnCount()) {
+		return Chunk();
+	}
+	auto offset = chunkOffsets[chunk * header->columnCount + column];
+	if(offset % 8 != 0 || offset < sizeof(Header) || offset + sizeof(ChunkHeader) > trailer->footerOffset) {
+		return Chunk();
+	}
+	auto hdr = reinterpret_cast<const ChunkHeader*>(data + offset);
+	if(hdr->count != getChunkStart(chunk + 1) - getChunkStart(chunk) ||
+	   hdr->size > trailer->footerOffset - offset - sizeof(ChunkHeader) || getContentSize(*hdr) > hdr->size) {
+		return Chunk();
+	}
+	return Chunk(hdr);
+}
+
+bool ColumnFile::build(Reader& reader, Print& out, const Settings& settings)
+{
+	unsigned columnCount = reader.count();
+	if(columnCount == 0 || columnCount > UINT16_MAX) {
+		return false;
+	}
+
+	Output output(out);
+	auto& headings = reader.getHeadings();
+	Header hdr{
+		.magic = magic,
+		.version = version,
+		.columnCount = uint16_t(columnCount),
+		.headingsSize = uint32_t(headings.length()),
+	};
+	output.write(&hdr, sizeof(hdr));
+	output.write(headings.c_str(), headings.length());
+	output.pad();
+
+	// Values for current chunk, by column
+	std::vector<String> buffers(columnCount);
+	std::vector<uint8_t> types(columnCount);
+	std::vector<uint32_t> chunkStarts;
+	std::vector<uint32_t> offsets;
+	StringPool pool;
+	uint32_t recordCount{0};
+	unsigned chunkRecords{0};
+	size_t chunkSize{0};
+
+	auto flush = [&]() {
+		if(chunkRecords == 0) {
+			return;
+		}
+		chunkStarts.push_back(recordCount - chunkRecords);
+		for(unsigned col = 0; col < columnCount; ++col) {
+			offsets.push_back(output.pos);
+			auto type = writeColumn(output, buffers[col], chunkRecords, settings, pool);
+			types[col] = uint8_t(combine(ValueType(types[col]), type));
+			buffers[col].setLength(0);
+		}
+		chunkRecords = 0;
+		chunkSize = 0;
+	};
+
+	while(output.ok && reader.next()) {
+		// Missing values are stored as empty strings and additional values are discarded
+		unsigned col{0};
+		for(auto value : reader.getRow()) {
+			if(col == columnCount) {
+				break;
+			}
+			auto len = strlen(value) + 1;
+			buffers[col].concat(value, len);
+			chunkSize += len;
+			++col;
+		}
+		for(; col < columnCount; ++col) {
+			buffers[col].concat('\0');
+			++chunkSize;
+		}
+		++chunkRecords;
+		++recordCount;
+		if(chunkRecords >= settings.chunkRecords || chunkSize >= settings.chunkSize) {
+			flush();
+		}
+	}
+	flush();
+
+	// Footer
+	Trailer trailer{
+		.footerOffset = output.pos,
+		.chunkCount = uint32_t(chunkStarts.size()),
+		.recordCount = recordCount,
+		.magic = magic,
+	};
+	output.write(types);
+	output.pad();
+	output.write(chunkStarts);
+	output.write(offsets);
+	output.pad();
+	output.write(&trailer, sizeof(trailer));
+	return output.ok;
+}
+
+} // namespace CSV
+
+String toString(CSV::ColumnFile::Encoding encoding)
+{
+	using Encoding = CSV::ColumnFile::Encoding;
+	switch(encoding) {
+	case Encoding::empty:
+		return F("empty");
+	case Encoding::integer:
+		return F("integer");
+	case Encoding::number:
+		return F("number");
+	case Encoding::text:
+		return F("text");
+	case Encoding::dictionary8:
+		return F("dictionary8");
+	case Encoding::dictionary16:
+		return F("dictionary16");
+	default:
+		return F("unknown");
+	}
+}
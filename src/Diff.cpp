@@ -0,0 +1,119 @@
+/****
+ * Diff.cpp
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include "include/CSV/Diff.h"
+#include <debug_progmem.h>
+
+namespace CSV
+{
+bool Diff::compare(Reader& oldReader, Reader& newReader, Callback callback)
+{
+	if(!oldReader.getOptions().hashFields || !newReader.getOptions().hashFields) {
+		debug_e("[CSV] Diff requires hashFields option");
+		return false;
+	}
+
+	summary = {};
+	entries.clear();
+	index.clear();
+
+	oldReader.reset();
+	while(oldReader.next()) {
+		if(!insert(Entry{getKey(oldReader), oldReader.getHash(), oldReader.tell(), false})) {
+			debug_e("[CSV] Diff out of memory");
+			entries = {};
+			index.clear();
+			return false;
+		}
+	}
+
+	newReader.reset();
+	while(newReader.next()) {
+		auto hash = newReader.getHash();
+		auto entry = match(getKey(newReader), hash);
+		if(entry == nullptr) {
+			++summary.inserted;
+			if(callback) {
+				callback(Change{Kind::inserted, Parser::BOF, newReader.tell()});
+			}
+			continue;
+		}
+		entry->matched = true;
+		if(entry->hash == hash) {
+			++summary.unchanged;
+			continue;
+		}
+		++summary.changed;
+		if(callback) {
+			callback(Change{Kind::changed, entry->start, newReader.tell()});
+		}
+	}
+
+	// Entries are in source order
+	for(auto& entry : entries) {
+		if(entry.matched) {
+			continue;
+		}
+		++summary.removed;
+		if(callback) {
+			callback(Change{Kind::removed, entry.start, Parser::BOF});
+		}
+	}
+	entries = {};
+	index.clear();
+
+	return true;
+}
+
+bool Diff::insert(const Entry& entry)
+{
+	if(!append(entries, entry)) {
+		return false;
+	}
+	if(!index.add(entry.key, entries.size() - 1, [this](unsigned i) { return entries[i].key; })) {
+		entries.pop_back();
+		return false;
+	}
+	return true;
+}
+
+/*
+ * Find an unmatched entry with the given key, preferring one with identical content
+ */
+Diff::Entry* Diff::match(uint32_t key, uint32_t hash)
+{
+	Entry* candidate{nullptr};
+	index.probe(key, [&](unsigned i) {
+		auto& entry = entries[i];
+		if(entry.key != key || entry.matched) {
+			return true;
+		}
+		if(entry.hash == hash) {
+			candidate = &entry;
+			return false;
+		}
+		if(candidate == nullptr) {
+			candidate = &entry;
+		}
+		return true;
+	});
+	return candidate;
+}
+
+} // namespace CSV
@@ -0,0 +1,548 @@
+/****
+ * ExternalSort.cpp
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include "include/CSV/ExternalSort.h"
+#include "include/CSV/Reader.h"
+#include "include/CSV/Number.h"
+#include <Data/Stream/FileStream.h>
+#include <debug_progmem.h>
+#include <algorithm>
+#include <vector>
+
+#ifdef ARCH_HOST
+#include <atomic>
+#include <deque>
+#include <thread>
+#endif
+
+namespace
+{
+constexpr unsigned prefixLength{8};
+constexpr size_t minChunkSize{1024};
+
+/*
+ * Key values are encoded so they can be ordered using memcmp()
+ */
+void encodeKey(const char* value, bool numeric, String& key)
+{
+	key.setLength(0);
+	if(value == nullptr) {
+		return;
+	}
+	if(numeric) {
+		double n;
+		if(CSV::parseNumber(value, n)) {
+			// Flip bits so that ordering of IEEE754 values matches unsigned big-endian ordering
+			uint64_t bits;
+			memcpy(&bits, &n, sizeof(bits));
+			bits = (bits >> 63) ? ~bits : bits | (1ULL << 63);
+			char buf[1 + sizeof(bits)];
+			buf[0] = '\0';
+			for(unsigned i = 0; i < sizeof(bits); ++i) {
+				buf[1 + i] = bits >> (56 - i * 8);
+			}
+			key.concat(buf, sizeof(buf));
+			return;
+		}
+		key.concat('\x01');
+	}
+	key.concat(value);
+}
+
+int compareKeys(const char* key1, size_t length1, const char* key2, size_t length2)
+{
+	int c = memcmp(key1, key2, std::min(length1, length2));
+	if(c != 0) {
+		return c;
+	}
+	return (length1 < length2) ? -1 : (length1 > length2);
+}
+
+/*
+ * Sort entry for one record. Most comparisons need only the prefix.
+ */
+struct Entry {
+	char prefix[prefixLength]; ///< Start of key, NUL-padded
+	uint32_t start;			   ///< Location of record in input
+	uint32_t length;		   ///< Number of source characters in record, excluding line ending
+	uint32_t keyOffset;		   ///< Location of full key in Chunk::keys
+	uint16_t keyLength;
+};
+
+struct Chunk {
+	std::vector<Entry> entries;
+	String keys;
+
+	void add(const CSV::Cursor& cursor, const String& key)
+	{
+		Entry entry{};
+		memcpy(entry.prefix, key.c_str(), std::min(key.length(), size_t(prefixLength)));
+		entry.start = cursor.start;
+		entry.length = cursor.length();
+		entry.keyOffset = keys.length();
+		entry.keyLength = key.length();
+		keys.concat(key);
+		entries.push_back(entry);
+	}
+
+	size_t getSize() const
+	{
+		return entries.size() * sizeof(Entry) + keys.length();
+	}
+
+	void sort()
+	{
+		auto keyData = keys.c_str();
+		std::sort(entries.begin(), entries.end(), [keyData](const Entry& e1, const Entry& e2) {
+			int c = memcmp(e1.prefix, e2.prefix, prefixLength);
+			if(c == 0) {
+				c = compareKeys(keyData + e1.keyOffset, e1.keyLength, keyData + e2.keyOffset, e2.keyLength);
+			}
+			// Records with equal keys remain in file order
+			return (c == 0) ? e1.start < e2.start : c < 0;
+		});
+	}
+};
+
+/*
+ * Collects output into a buffer to minimise calls to file system
+ */
+class BufferedWriter
+{
+public:
+	BufferedWriter(Print& out, size_t bufferSize) : out(out), bufferSize(bufferSize)
+	{
+	}
+
+	~BufferedWriter()
+	{
+		flush();
+	}
+
+	bool write(const void* data, size_t length)
+	{
+		if(!buffer.concat(static_cast<const char*>(data), length)) {
+			return false;
+		}
+		return buffer.length() < bufferSize || flush();
+	}
+
+	/*
+	 * Copy data from a stream
+	 */
+	bool copy(IDataSourceStream& source, size_t length)
+	{
+		auto offset = buffer.length();
+		if(!buffer.setLength(offset + length)) {
+			return false;
+		}
+		if(source.readBytes(buffer.begin() + offset, length) != length) {
+			return false;
+		}
+		return buffer.length() < bufferSize || flush();
+	}
+
+	bool flush()
+	{
+		auto length = buffer.length();
+		bool ok = out.write(reinterpret_cast<const uint8_t*>(buffer.c_str()), length) == length;
+		buffer.setLength(0);
+		return ok;
+	}
+
+private:
+	Print& out;
+	String buffer;
+	size_t bufferSize;
+};
+
+/*
+ * Run files contain a sequence of frames:
+ *
+ *	uint16_t keyLength
+ *	char key[keyLength]
+ *	uint32_t recordLength
+ *	char record[recordLength]
+ */
+bool writeRun(IFS::FileSystem* fs, const String& input, const String& filename, Chunk& chunk, size_t bufferSize)
+{
+	chunk.sort();
+
+	FileStream source(fs);
+	FileStream file(fs);
+	if(!source.open(input, File::ReadOnly) || !file.open(filename, File::CreateNewAlways | File::WriteOnly)) {
+		debug_e("[CSV] Failed to create run '%s'", filename.c_str());
+		return false;
+	}
+
+	BufferedWriter out(file, bufferSize);
+	for(auto& e : chunk.entries) {
+		uint32_t recordLength = e.length + 1;
+		if(source.seekFrom(e.start, SeekOrigin::Start) != int(e.start)) {
+			return false;
+		}
+		if(!out.write(&e.keyLength, sizeof(e.keyLength)) ||
+		   !out.write(chunk.keys.c_str() + e.keyOffset, e.keyLength) ||
+		   !out.write(&recordLength, sizeof(recordLength)) || !out.copy(source, e.length) || !out.write("\n", 1)) {
+			return false;
+		}
+	}
+	return out.flush();
+}
+
+/*
+ * Reads frames from a run file
+ */
+class RunReader
+{
+public:
+	RunReader(IFS::FileSystem* fs, const String& filename, unsigned index, size_t bufferSize)
+		: file(fs), index(index), bufferSize(bufferSize)
+	{
+		if(!file.open(filename, File::ReadOnly)) {
+			debug_e("[CSV] Failed to open run '%s'", filename.c_str());
+			error = true;
+		}
+	}
+
+	/*
+	 * Returns false at end of run or on error. Data ending within a frame is an error.
+	 */
+	bool next()
+	{
+		if(error) {
+			return false;
+		}
+		if(pos == buffer.length() && !fill()) {
+			return false;
+		}
+		uint16_t keyLength;
+		uint32_t recordLength;
+		if(read(&keyLength, sizeof(keyLength)) && readString(key, keyLength) &&
+		   read(&recordLength, sizeof(recordLength)) && readString(record, recordLength)) {
+			return true;
+		}
+		debug_e("[CSV] Run '%s' is truncated", file.getName().c_str());
+		error = true;
+		return false;
+	}
+
+	bool hasError() const
+	{
+		return error;
+	}
+
+	/*
+	 * Heap ordering, so returns true if this record follows other
+	 */
+	bool operator>(const RunReader& other) const
+	{
+		int c = compareKeys(key.c_str(), key.length(), other.key.c_str(), other.key.length());
+		return (c == 0) ? index > other.index : c > 0;
+	}
+
+	String key;
+	String record;
+
+private:
+	/*
+	 * Refill buffer, returns false at end of file
+	 */
+	bool fill()
+	{
+		if(!buffer.setLength(bufferSize)) {
+			error = true;
+			return false;
+		}
+		buffer.setLength(file.readBytes(buffer.begin(), bufferSize));
+		pos = 0;
+		if(file.getLastError() < 0) {
+			error = true;
+		}
+		return !error && buffer.length() != 0;
+	}
+
+	bool read(void* data, size_t length)
+	{
+		auto ptr = static_cast<char*>(data);
+		while(length != 0) {
+			if(pos == buffer.length() && !fill()) {
+				return false;
+			}
+			auto n = std::min(length, buffer.length() - pos);
+			memcpy(ptr, buffer.c_str() + pos, n);
+			pos += n;
+			ptr += n;
+			length -= n;
+		}
+		return true;
+	}
+
+	bool readString(String& s, size_t length)
+	{
+		return s.setLength(length) && read(s.begin(), length);
+	}
+
+	FileStream file;
+	String buffer;
+	size_t pos{0};
+	unsigned index;
+	size_t bufferSize;
+	bool error{false};
+};
+
+/*
+ * Merge a set of runs, writing either records only or frames for another run.
+ * Ties are resolved by position in `names` so runs must be given in source order.
+ */
+bool mergeRuns(IFS::FileSystem* fs, const std::vector<String>& names, BufferedWriter& out, size_t bufferSize,
+			   bool writeFrames)
+{
+	std::vector<std::unique_ptr<RunReader>> runs;
+	std::vector<RunReader*> heap;
+	for(unsigned i = 0; i < names.size(); ++i) {
+		auto run = new RunReader(fs, names[i], i, bufferSize);
+		runs.emplace_back(run);
+		if(run->next()) {
+			heap.push_back(run);
+		} else if(run->hasError()) {
+			return false;
+		}
+	}
+
+	auto greater = [](const RunReader* r1, const RunReader* r2) { return *r1 > *r2; };
+	std::make_heap(heap.begin(), heap.end(), greater);
+	while(!heap.empty()) {
+		std::pop_heap(heap.begin(), heap.end(), greater);
+		auto run = heap.back();
+		if(writeFrames) {
+			uint16_t keyLength = run->key.length();
+			uint32_t recordLength = run->record.length();
+			if(!out.write(&keyLength, sizeof(keyLength)) || !out.write(run->key.c_str(), keyLength) ||
+			   !out.write(&recordLength, sizeof(recordLength))) {
+				return false;
+			}
+		}
+		if(!out.write(run->record.c_str(), run->record.length())) {
+			return false;
+		}
+		if(run->next()) {
+			std::push_heap(heap.begin(), heap.end(), greater);
+		} else if(run->hasError()) {
+			return false;
+		} else {
+			heap.pop_back();
+		}
+	}
+
+	return out.flush();
+}
+
+} // namespace
+
+namespace CSV
+{
+String ExternalSort::getRunName(unsigned run) const
+{
+	String name = tempPrefix;
+	name += '.';
+	name += run;
+	name += ".tmp";
+	return name;
+}
+
+bool ExternalSort::sort(const String& input, const String& output, unsigned column)
+{
+	tempPrefix = settings.tempPrefix ?: output;
+	return writeRuns(input, column) && merge(output);
+}
+
+bool ExternalSort::createRuns(const String& input, unsigned column)
+{
+	tempPrefix = settings.tempPrefix ?: input;
+	return writeRuns(input, column);
+}
+
+bool ExternalSort::merge(const String& output)
+{
+	if(!inputName) {
+		return false;
+	}
+	bool ok = writeOutput(output);
+	removeRuns();
+	inputName = nullptr;
+	return ok;
+}
+
+void ExternalSort::removeRuns()
+{
+	for(unsigned i = 0; i < fileCount; ++i) {
+		fileSystem->remove(getRunName(i).c_str());
+	}
+	fileCount = 0;
+}
+
+bool ExternalSort::writeRuns(const String& input, unsigned column)
+{
+	runCount = 0;
+	fileCount = 0;
+	mergePassCount = 0;
+	recordCount = 0;
+	inputName = nullptr;
+	fileSystem = settings.fileSystem ?: ::getFileSystem();
+
+	auto source = new FileStream(fileSystem);
+	if(!source->open(input, File::ReadOnly)) {
+		debug_e("[CSV] Failed to open '%s'", input.c_str());
+		delete source;
+		return false;
+	}
+	Reader reader(source, options);
+
+#ifdef ARCH_HOST
+	unsigned threadCount = settings.threadCount ?: std::max(std::thread::hardware_concurrency(), 1U);
+	/*
+	 * Each writer thread has a chunk, plus the one being filled.
+	 * Limit threads so chunks don't become too small to be useful.
+	 */
+	threadCount = std::min(threadCount, std::max(unsigned(settings.memoryLimit / minChunkSize), 2U) - 1);
+	const size_t chunkLimit = settings.memoryLimit / (threadCount + 1);
+	std::deque<std::thread> threads;
+	std::atomic<bool> ok{true};
+	auto spill = [&](Chunk& chunk) {
+		if(threads.size() == threadCount) {
+			threads.front().join();
+			threads.pop_front();
+		}
+		threads.emplace_back([this, &input, &ok, name = getRunName(runCount), chunk = std::move(chunk)]() mutable {
+			if(!writeRun(fileSystem, input, name, chunk, settings.bufferSize)) {
+				ok = false;
+			}
+		});
+		++runCount;
+	};
+#else
+	// Chunks are written synchronously
+	const size_t chunkLimit = settings.memoryLimit;
+	bool ok{true};
+	auto spill = [&](Chunk& chunk) {
+		ok = writeRun(fileSystem, input, getRunName(runCount), chunk, settings.bufferSize) && ok;
+		++runCount;
+	};
+#endif
+
+	headerLength = -1;
+	Chunk chunk;
+	String key;
+	while(ok && reader.next()) {
+		if(headerLength < 0) {
+			headerLength = reader.tell();
+		}
+		encodeKey(reader.getValue(column), settings.numeric, key);
+		chunk.add(reader.getCursor(), key);
+		++recordCount;
+		if(chunk.getSize() >= chunkLimit) {
+			spill(chunk);
+			chunk = Chunk{};
+		}
+	}
+	if(!chunk.entries.empty()) {
+		spill(chunk);
+	}
+
+#ifdef ARCH_HOST
+	for(auto& thread : threads) {
+		thread.join();
+	}
+#endif
+
+	fileCount = runCount;
+	if(!ok) {
+		removeRuns();
+		return false;
+	}
+	inputName = input;
+	return true;
+}
+
+bool ExternalSort::writeOutput(const String& output)
+{
+	FileStream file(fileSystem);
+	if(!file.open(output, File::CreateNewAlways | File::WriteOnly)) {
+		debug_e("[CSV] Failed to create '%s'", output.c_str());
+		return false;
+	}
+	BufferedWriter out(file, settings.bufferSize);
+
+	// Header is copied unchanged, or entire file if there are no records
+	{
+		FileStream source(fileSystem);
+		if(!source.open(inputName, File::ReadOnly)) {
+			return false;
+		}
+		size_t length = (headerLength < 0) ? source.available() : headerLength;
+		if(!out.copy(source, length)) {
+			return false;
+		}
+	}
+
+	/*
+	 * Each run being merged needs a buffer, as does the output.
+	 * If there are too many runs, merge groups of consecutive runs into new runs until there are few enough.
+	 */
+	const unsigned maxFanIn = std::max(unsigned(settings.memoryLimit / settings.bufferSize), 3U) - 1;
+	std::vector<String> runs;
+	for(unsigned i = 0; i < runCount; ++i) {
+		runs.push_back(getRunName(i));
+	}
+	while(runs.size() > maxFanIn) {
+		std::vector<String> merged;
+		for(unsigned i = 0; i < runs.size(); i += maxFanIn) {
+			std::vector<String> group;
+			for(unsigned j = i; j < runs.size() && j < i + maxFanIn; ++j) {
+				group.push_back(runs[j]);
+			}
+			if(group.size() == 1) {
+				merged.push_back(group[0]);
+				continue;
+			}
+			auto name = getRunName(fileCount++);
+			FileStream runFile(fileSystem);
+			if(!runFile.open(name, File::CreateNewAlways | File::WriteOnly)) {
+				debug_e("[CSV] Failed to create run '%s'", name.c_str());
+				return false;
+			}
+			BufferedWriter runOut(runFile, settings.bufferSize);
+			if(!mergeRuns(fileSystem, group, runOut, settings.bufferSize, true)) {
+				return false;
+			}
+			for(auto& runName : group) {
+				fileSystem->remove(runName.c_str());
+			}
+			merged.push_back(name);
+		}
+		runs = std::move(merged);
+		++mergePassCount;
+	}
+
+	++mergePassCount;
+	return mergeRuns(fileSystem, runs, out, settings.bufferSize, false);
+}
+
+} // namespace CSV
@@ -0,0 +1,207 @@
+/****
+ * FlashTable.cpp
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include "include/CSV/FlashTable.h"
+#include <vector>
+
+namespace CSV
+{
+FlashTable::FlashTable(const FSTR::ObjectBase& data) : data(data)
+{
+	if(data.read(0, &header, sizeof(header)) != sizeof(header) || header.magic != magic) {
+		header = {};
+		return;
+	}
+	size_t indexSize = ((header.recordCount + 1) * header.columnCount + 1) * sizeof(uint32_t);
+	if(header.dataOffset < sizeof(Header) + indexSize || header.dataOffset > data.length()) {
+		header = {};
+	}
+}
+
+bool FlashTable::getField(unsigned row, unsigned column, uint32_t& offset, uint32_t& length) const
+{
+	if(row > header.recordCount || column >= header.columnCount) {
+		return false;
+	}
+	auto index = row * header.columnCount + column;
+	offset = getOffset(index);
+	// Values are NUL-terminated
+	length = getOffset(index + 1) - offset - 1;
+	offset += header.dataOffset;
+	return true;
+}
+
+int FlashTable::getLength(unsigned record, unsigned column) const
+{
+	uint32_t offset, length;
+	return getField(record + 1, column, offset, length) ? int(length) : -1;
+}
+
+int FlashTable::read(unsigned record, unsigned column, char* buffer, size_t bufSize) const
+{
+	uint32_t offset, length;
+	if(!getField(record + 1, column, offset, length) || bufSize == 0) {
+		return -1;
+	}
+	auto len = std::min(size_t(length), bufSize - 1);
+	data.read(offset, buffer, len);
+	buffer[len] = '\0';
+	return length;
+}
+
+String FlashTable::readValue(unsigned row, unsigned column) const
+{
+	uint32_t offset, length;
+	if(!getField(row, column, offset, length)) {
+		return nullptr;
+	}
+	String s;
+	if(s.setLength(length)) {
+		data.read(offset, s.begin(), length);
+	}
+	return s;
+}
+
+CStringArray FlashTable::getRow(unsigned record) const
+{
+	if(record >= header.recordCount) {
+		return nullptr;
+	}
+	auto index = (record + 1) * header.columnCount;
+	auto start = getOffset(index);
+	auto length = getOffset(index + header.columnCount) - start;
+	String s;
+	if(!s.setLength(length)) {
+		return nullptr;
+	}
+	data.read(header.dataOffset + start, s.begin(), length);
+	return CStringArray(std::move(s));
+}
+
+int FlashTable::getColumn(const char* name) const
+{
+	if(name == nullptr) {
+		return -1;
+	}
+	auto len = strlen(name);
+	for(unsigned col = 0; col < header.columnCount; ++col) {
+		uint32_t offset, length;
+		if(getField(0, col, offset, length) && length == len && compare(offset, name, len)) {
+			return col;
+		}
+	}
+	return -1;
+}
+
+int FlashTable::find(unsigned column, const char* value, unsigned startRecord) const
+{
+	if(value == nullptr) {
+		return -1;
+	}
+	auto len = strlen(value);
+	for(unsigned record = startRecord; record < header.recordCount; ++record) {
+		uint32_t offset, length;
+		if(!getField(record + 1, column, offset, length)) {
+			return -1;
+		}
+		// Field lengths are known so most records are rejected without reading their content
+		if(length == len && compare(offset, value, len)) {
+			return record;
+		}
+	}
+	return -1;
+}
+
+bool FlashTable::compare(uint32_t offset, const char* value, size_t length) const
+{
+	char buf[32] __attribute__((aligned(4)));
+	while(length != 0) {
+		auto n = std::min(length, sizeof(buf));
+		data.read(offset, buf, n);
+		if(memcmp(buf, value, n) != 0) {
+			return false;
+		}
+		offset += n;
+		value += n;
+		length -= n;
+	}
+	return true;
+}
+
+bool FlashTable::build(Reader& reader, Print& out)
+{
+	unsigned columnCount = reader.count();
+	if(columnCount == 0 || columnCount > UINT16_MAX) {
+		return false;
+	}
+
+	std::vector<uint32_t> offsets;
+	uint32_t dataSize{0};
+	auto addRow = [&](const CStringArray& row) {
+		for(unsigned col = 0; col < columnCount; ++col) {
+			offsets.push_back(dataSize);
+			auto value = row[col];
+			dataSize += (value ? strlen(value) : 0) + 1;
+		}
+	};
+
+	// First pass: determine layout
+	addRow(reader.getHeadings());
+	reader.reset();
+	while(reader.next()) {
+		addRow(reader.getRow());
+	}
+	offsets.push_back(dataSize);
+
+	Header hdr{
+		.magic = magic,
+		.columnCount = uint16_t(columnCount),
+		.recordCount = uint32_t(offsets.size() / columnCount - 1),
+		.dataOffset = uint32_t(sizeof(Header) + offsets.size() * sizeof(uint32_t)),
+	};
+	size_t indexSize = offsets.size() * sizeof(uint32_t);
+	if(out.write(reinterpret_cast<const uint8_t*>(&hdr), sizeof(hdr)) != sizeof(hdr) ||
+	   out.write(reinterpret_cast<const uint8_t*>(offsets.data()), indexSize) != indexSize) {
+		reader.reset();
+		return false;
+	}
+
+	// Second pass: write values
+	bool ok{true};
+	auto writeRow = [&](const CStringArray& row) {
+		for(unsigned col = 0; col < columnCount; ++col) {
+			auto value = row[col] ?: "";
+			size_t len = strlen(value) + 1;
+			ok = ok && out.write(reinterpret_cast<const uint8_t*>(value), len) == len;
+		}
+	};
+	writeRow(reader.getHeadings());
+	reader.reset();
+	while(ok && reader.next()) {
+		writeRow(reader.getRow());
+	}
+	reader.reset();
+
+	// Pad to word boundary
+	const uint8_t padding[3]{};
+	auto padLen = (4 - dataSize % 4) % 4;
+	return ok && out.write(padding, padLen) == padLen;
+}
+
+} // namespace CSV
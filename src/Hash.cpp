@@ -0,0 +1,94 @@
+/****
+ * Hash.cpp
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include "include/CSV/Hash.h"
+
+namespace
+{
+constexpr uint32_t prime1{2654435761U};
+constexpr uint32_t prime2{2246822519U};
+constexpr uint32_t prime3{3266489917U};
+constexpr uint32_t prime4{668265263U};
+constexpr uint32_t prime5{374761393U};
+
+inline uint32_t rotl(uint32_t value, unsigned count)
+{
+	return (value << count) | (value >> (32 - count));
+}
+
+// Little-endian, unaligned
+inline uint32_t read32(const uint8_t* ptr)
+{
+	return ptr[0] | (ptr[1] << 8) | (ptr[2] << 16) | (uint32_t(ptr[3]) << 24);
+}
+
+inline uint32_t mixLane(uint32_t acc, uint32_t input)
+{
+	acc += input * prime2;
+	return rotl(acc, 13) * prime1;
+}
+
+} // namespace
+
+namespace CSV
+{
+uint32_t xxh32(const void* data, size_t length, uint32_t seed)
+{
+	auto ptr = static_cast<const uint8_t*>(data);
+	auto end = ptr + length;
+	uint32_t hash;
+
+	if(length >= 16) {
+		auto limit = end - 16;
+		uint32_t v1 = seed + prime1 + prime2;
+		uint32_t v2 = seed + prime2;
+		uint32_t v3 = seed;
+		uint32_t v4 = seed - prime1;
+		do {
+			v1 = mixLane(v1, read32(ptr));
+			v2 = mixLane(v2, read32(ptr + 4));
+			v3 = mixLane(v3, read32(ptr + 8));
+			v4 = mixLane(v4, read32(ptr + 12));
+			ptr += 16;
+		} while(ptr <= limit);
+		hash = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+	} else {
+		hash = seed + prime5;
+	}
+
+	hash += uint32_t(length);
+
+	for(; ptr + 4 <= end; ptr += 4) {
+		hash += read32(ptr) * prime3;
+		hash = rotl(hash, 17) * prime4;
+	}
+	for(; ptr < end; ++ptr) {
+		hash += *ptr * prime5;
+		hash = rotl(hash, 11) * prime1;
+	}
+
+	hash ^= hash >> 15;
+	hash *= prime2;
+	hash ^= hash >> 13;
+	hash *= prime3;
+	hash ^= hash >> 16;
+	return hash;
+}
+
+} // namespace CSV
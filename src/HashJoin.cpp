@@ -0,0 +1,152 @@
+/****
+ * HashJoin.cpp
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include "include/CSV/HashJoin.h"
+#include "include/CSV/Hash.h"
+#include <debug_progmem.h>
+
+namespace CSV
+{
+namespace
+{
+/*
+ * Get view of stored fields following key
+ */
+ArenaRow getFields(const ArenaRow& row, size_t keyLength)
+{
+	if(row.count() < 2) {
+		return ArenaRow();
+	}
+	return ArenaRow(row.c_str() + keyLength + 1, row.length() - keyLength - 1, row.count() - 1);
+}
+
+} // namespace
+
+bool HashJoin::build(Reader& reader, unsigned keyColumn, const std::vector<unsigned>& columns)
+{
+	clear();
+
+	reader.reset();
+	while(error == Error::none && reader.next()) {
+		error = add(reader, keyColumn, columns);
+	}
+	reader.reset();
+
+	switch(error) {
+	case Error::none:
+		return true;
+	case Error::noMemory:
+		debug_e("[CSV] Hash join out of memory after %u records", count());
+		break;
+	case Error::recordTooLong:
+		debug_e("[CSV] Hash join record too long after %u records", count());
+		break;
+	}
+	auto err = error;
+	clear();
+	error = err;
+	return false;
+}
+
+HashJoin::Error HashJoin::add(const Reader& reader, unsigned keyColumn, const std::vector<unsigned>& columns)
+{
+	auto key = reader.getValue(keyColumn);
+	if(key == nullptr || *key == '\0') {
+		return Error::none;
+	}
+
+	auto keyLength = strlen(key);
+	size_t length = keyLength + 1;
+	for(auto col : columns) {
+		auto value = reader.getValue(col);
+		length += (value ? strlen(value) : 0) + 1;
+	}
+	if(length > UINT16_MAX) {
+		return Error::recordTooLong;
+	}
+
+	auto data = static_cast<char*>(arena.allocate(length, 1));
+	if(data == nullptr) {
+		return Error::noMemory;
+	}
+	memcpy(data, key, keyLength + 1);
+	auto ptr = data + keyLength + 1;
+	for(auto col : columns) {
+		auto value = reader.getValue(col) ?: "";
+		auto len = strlen(value) + 1;
+		memcpy(ptr, value, len);
+		ptr += len;
+	}
+
+	auto hash = fnv1a(key, keyLength);
+	if(!append(entries, Entry{ArenaRow(data, length, 1 + columns.size()), reader.tell(), hash})) {
+		return Error::noMemory;
+	}
+	if(!index.add(hash, entries.size() - 1, [this](unsigned i) { return entries[i].hash; })) {
+		entries.pop_back();
+		return Error::noMemory;
+	}
+	return checkMemory() ? Error::none : Error::noMemory;
+}
+
+unsigned HashJoin::join(Reader& probe, unsigned keyColumn, Callback callback, bool outer)
+{
+	unsigned count{0};
+	while(probe.next()) {
+		bool matched{false};
+		bool stop{false};
+		auto key = probe.getValue(keyColumn);
+		if(key != nullptr && *key != '\0') {
+			auto keyLength = strlen(key);
+			auto hash = fnv1a(key, keyLength);
+			// Entries with equal keys are visited in source order
+			index.probe(hash, [&](unsigned i) {
+				auto& entry = entries[i];
+				if(entry.hash != hash || strcmp(entry.row.c_str(), key) != 0) {
+					return true;
+				}
+				matched = true;
+				++count;
+				stop = callback && !callback(probe, Match{entry.start, getFields(entry.row, keyLength)});
+				return !stop;
+			});
+		}
+		if(stop) {
+			return count;
+		}
+		if(outer && !matched) {
+			++count;
+			if(callback && !callback(probe, Match{Parser::BOF, ArenaRow()})) {
+				return count;
+			}
+		}
+	}
+	return count;
+}
+
+void HashJoin::clear()
+{
+	arena.clear();
+	entries.clear();
+	entries.shrink_to_fit();
+	index.clear();
+	error = Error::none;
+}
+
+} // namespace CSV
@@ -0,0 +1,103 @@
+/****
+ * HyperLogLog.cpp
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include "include/CSV/HyperLogLog.h"
+#include "include/CSV/Hash.h"
+#include <algorithm>
+#include <cmath>
+
+namespace CSV
+{
+HyperLogLog::HyperLogLog(uint8_t precision)
+	: precision(std::min(std::max(precision, minPrecision), maxPrecision))
+{
+	registers.resize(1U << this->precision);
+}
+
+void HyperLogLog::add(const char* value, size_t length)
+{
+	addHash(xxh32(value, length));
+}
+
+void HyperLogLog::addHash(uint32_t hash)
+{
+	// Top bits select register, remainder gives position of first set bit
+	auto index = hash >> (32 - precision);
+	uint32_t w = hash << precision;
+	uint8_t rank = w ? __builtin_clz(w) + 1 : 32 - precision + 1;
+	auto& reg = registers[index];
+	if(rank > reg) {
+		reg = rank;
+	}
+}
+
+bool HyperLogLog::merge(const HyperLogLog& other)
+{
+	if(other.precision != precision) {
+		return false;
+	}
+	for(unsigned i = 0; i < registers.size(); ++i) {
+		registers[i] = std::max(registers[i], other.registers[i]);
+	}
+	return true;
+}
+
+uint32_t HyperLogLog::estimate() const
+{
+	const double m = registers.size();
+	double alpha;
+	switch(registers.size()) {
+	case 16:
+		alpha = 0.673;
+		break;
+	case 32:
+		alpha = 0.697;
+		break;
+	case 64:
+		alpha = 0.709;
+		break;
+	default:
+		alpha = 0.7213 / (1 + 1.079 / m);
+	}
+
+	double sum{0};
+	unsigned zeros{0};
+	for(auto reg : registers) {
+		sum += ldexp(1.0, -reg);
+		if(reg == 0) {
+			++zeros;
+		}
+	}
+	double e = alpha * m * m / sum;
+
+	// Small range correction using linear counting
+	if(e <= 2.5 * m && zeros != 0) {
+		e = m * log(m / zeros);
+	}
+
+	// Large range correction for hash collisions
+	constexpr double limit{4294967296.0};
+	if(e > limit / 30) {
+		e = (e < limit) ? -limit * log(1 - e / limit) : limit;
+	}
+
+	return std::min(round(e), double(UINT32_MAX));
+}
+
+} // namespace CSV
@@ -0,0 +1,111 @@
+/****
+ * IncrementalParser.cpp
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include "include/CSV/IncrementalParser.h"
+#include <Platform/System.h>
+#include <Platform/Timers.h>
+#include <debug_progmem.h>
+
+namespace CSV
+{
+size_t IncrementalParser::write(const char* data, size_t length)
+{
+	if(readPos >= compactThreshold && readPos >= getPending()) {
+		// Discard data already parsed
+		queue.remove(0, readPos);
+		readPos = 0;
+	}
+	if(!queue.concat(data, length)) {
+		debug_e("[CSV] Out of memory queuing %u bytes", length);
+		return 0;
+	}
+	return length;
+}
+
+IncrementalParser::Status IncrementalParser::process(const Budget& budget)
+{
+	if(status == Status::complete || status == Status::aborted) {
+		return status;
+	}
+
+	OneShotFastUs timer(budget.time);
+	auto startPos = getCursor().end;
+	for(;;) {
+		if(readPos < queue.length()) {
+			if(!push(queue.c_str(), queue.length(), readPos)) {
+				if(readPos < queue.length()) {
+					// Parser buffer allocation failed
+					return status = Status::aborted;
+				}
+				continue;
+			}
+		} else if(!finished) {
+			// Keep allocation for next write
+			queue.setLength(0);
+			readPos = 0;
+			return status = Status::needData;
+		} else if(!flush()) {
+			queue = nullptr;
+			readPos = 0;
+			return status = Status::complete;
+		}
+
+		if(onRow && !onRow(getRow())) {
+			return status = Status::aborted;
+		}
+
+		if(budget.bytes != 0 && getCursor().end - startPos >= budget.bytes) {
+			return status = Status::yield;
+		}
+		if(budget.time != 0 && timer.expired()) {
+			return status = Status::yield;
+		}
+	}
+}
+
+bool IncrementalParser::run()
+{
+	if(scheduled) {
+		return true;
+	}
+	scheduled = System.queueCallback(TaskDelegate(&IncrementalParser::task, this));
+	return scheduled;
+}
+
+void IncrementalParser::task()
+{
+	scheduled = false;
+	switch(process()) {
+	case Status::yield:
+		run();
+		break;
+	case Status::needData:
+		break;
+	case Status::complete:
+	case Status::aborted:
+		if(completeCallback) {
+			// Take copy as parser may be destroyed by callback
+			auto callback = completeCallback;
+			callback(status);
+		}
+		break;
+	}
+}
+
+} // namespace CSV
@@ -0,0 +1,160 @@
+/****
+ * Index.cpp
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include "include/CSV/Index.h"
+#include "include/CSV/Memory.h"
+#include <algorithm>
+
+namespace
+{
+constexpr uint32_t indexMagic{0x58565343}; // "CSVX"
+
+struct IndexHeader {
+	uint32_t magic;
+	uint16_t prefixLength;
+	uint16_t column;
+	uint32_t count;
+};
+
+} // namespace
+
+namespace CSV
+{
+bool Index::build(Reader& reader, unsigned column)
+{
+	this->column = column;
+	entries.clear();
+
+	reader.reset();
+	while(reader.next()) {
+		Entry entry{};
+		auto value = reader.getValue(column);
+		if(value != nullptr) {
+			strncpy(entry.key, value, prefixLength);
+		}
+		entry.start = reader.tell();
+		if(!append(entries, entry)) {
+			entries.clear();
+			reader.reset();
+			return false;
+		}
+	}
+	reader.reset();
+
+	// Records with equal keys remain in file order
+	std::stable_sort(entries.begin(), entries.end(), [](const Entry& e1, const Entry& e2) {
+		return memcmp(e1.key, e2.key, prefixLength) < 0;
+	});
+
+	return true;
+}
+
+std::pair<Index::Iterator, Index::Iterator> Index::range(const char* prefix) const
+{
+	// Compare only as many characters as are present in the prefix
+	auto len = std::min(strlen(prefix), size_t(prefixLength));
+
+	auto first = std::lower_bound(entries.begin(), entries.end(), prefix, [len](const Entry& e, const char* key) {
+		return memcmp(e.key, key, len) < 0;
+	});
+	auto last = std::upper_bound(first, entries.end(), prefix, [len](const char* key, const Entry& e) {
+		return memcmp(key, e.key, len) < 0;
+	});
+	return {first, last};
+}
+
+unsigned Index::lookup(Reader& reader, const char* key, bool exact, Callback callback) const
+{
+	if(key == nullptr) {
+		return 0;
+	}
+
+	auto keyLength = strlen(key);
+	auto r = range(key);
+	unsigned matchCount{0};
+	for(auto it = r.first; it != r.second; ++it) {
+		if(!reader.seek(it->start)) {
+			return matchCount;
+		}
+		// Verify characters beyond those stored in the index
+		auto value = reader.getValue(column);
+		if(value == nullptr) {
+			continue;
+		}
+		if(exact ? strcmp(value, key) != 0 : strncmp(value, key, keyLength) != 0) {
+			continue;
+		}
+		++matchCount;
+		if(!callback || !callback(reader)) {
+			break;
+		}
+	}
+	return matchCount;
+}
+
+bool Index::find(Reader& reader, const char* key) const
+{
+	return lookup(reader, key, true, nullptr) != 0;
+}
+
+unsigned Index::findPrefix(Reader& reader, const char* prefix, Callback callback) const
+{
+	return lookup(reader, prefix, false, callback);
+}
+
+bool Index::save(Print& out) const
+{
+	IndexHeader hdr{indexMagic, prefixLength, uint16_t(column), uint32_t(entries.size())};
+	if(out.write(reinterpret_cast<const uint8_t*>(&hdr), sizeof(hdr)) != sizeof(hdr)) {
+		return false;
+	}
+	size_t size = entries.size() * sizeof(Entry);
+	return out.write(reinterpret_cast<const uint8_t*>(entries.data()), size) == size;
+}
+
+bool Index::load(Stream& in)
+{
+	entries.clear();
+
+	IndexHeader hdr;
+	if(in.readBytes(reinterpret_cast<char*>(&hdr), sizeof(hdr)) != sizeof(hdr)) {
+		return false;
+	}
+	if(hdr.magic != indexMagic || hdr.prefixLength != prefixLength) {
+		return false;
+	}
+	// Check count before allocating any memory
+	if(hdr.count > SIZE_MAX / sizeof(Entry)) {
+		return false;
+	}
+	size_t size = hdr.count * sizeof(Entry);
+	int available = in.available();
+	if((available >= 0 && size > size_t(available)) || !reserve(entries, hdr.count)) {
+		return false;
+	}
+	entries.resize(hdr.count);
+	if(in.readBytes(reinterpret_cast<char*>(entries.data()), size) != size) {
+		entries.clear();
+		return false;
+	}
+	column = hdr.column;
+	return true;
+}
+
+} // namespace CSV
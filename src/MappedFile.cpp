@@ -0,0 +1,60 @@
+/****
+ * MappedFile.cpp
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include "include/CSV/MappedFile.h"
+
+#if defined(ARCH_HOST) && !defined(__WIN32)
+
+#include <debug_progmem.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace CSV
+{
+MappedFile::MappedFile(const char* filename)
+{
+	int fd = ::open(filename, O_RDONLY);
+	if(fd < 0) {
+		debug_e("[CSV] Failed to open '%s'", filename);
+		return;
+	}
+	struct stat st;
+	if(fstat(fd, &st) == 0 && st.st_size > 0) {
+		auto ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(ptr != MAP_FAILED) {
+			data = ptr;
+			length = st.st_size;
+		}
+	}
+	// Mapping remains valid after file is closed
+	::close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+	if(data) {
+		munmap(data, length);
+	}
+}
+
+} // namespace CSV
+
+#endif // ARCH_HOST && !__WIN32
@@ -0,0 +1,96 @@
+/****
+ * MultiReader.cpp
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include "include/CSV/MultiReader.h"
+#include <Data/Stream/FileStream.h>
+
+namespace CSV
+{
+MultiReader::MultiReader(OpenShard openShard, const Parser::Options& options, const CStringArray& headings,
+						 bool prefetch)
+	: open(openShard), reader(openShard ? openShard(0) : nullptr, options, headings), prefetch(prefetch)
+{
+	if(prefetch && reader) {
+		nextSource.reset(open(1));
+		prefetched = true;
+	}
+}
+
+MultiReader::MultiReader(const CStringArray& filenames, const Parser::Options& options,
+						 const CStringArray& headings)
+	: MultiReader(
+		  [filenames](unsigned shard) -> IDataSourceStream* {
+			  auto filename = filenames[shard];
+			  if(filename == nullptr) {
+				  return nullptr;
+			  }
+			  auto stream = new FileStream(filename);
+			  if(!stream->fileExist()) {
+				  delete stream;
+				  return nullptr;
+			  }
+			  return stream;
+		  },
+		  options, headings)
+{
+}
+
+bool MultiReader::openShard(unsigned index)
+{
+	IDataSourceStream* source;
+	if(prefetched && index == shard + 1) {
+		// May be nullptr if there are no more shards
+		source = nextSource.release();
+	} else {
+		nextSource.reset();
+		source = open ? open(index) : nullptr;
+	}
+	prefetched = false;
+	shard = index;
+	if(!reader.setSource(source)) {
+		return false;
+	}
+	if(prefetch) {
+		nextSource.reset(open(index + 1));
+		prefetched = true;
+	}
+	return true;
+}
+
+bool MultiReader::next()
+{
+	while(!reader.next()) {
+		if(!reader || !openShard(shard + 1)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool MultiReader::seek(const Position& pos)
+{
+	if(pos.shard != shard || !reader) {
+		if(!openShard(pos.shard)) {
+			return false;
+		}
+	}
+	return reader.seek(pos.offset);
+}
+
+} // namespace CSV
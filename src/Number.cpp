@@ -0,0 +1,178 @@
+/****
+ * Number.cpp
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include "include/CSV/Number.h"
+#include <cmath>
+#include <cctype>
+
+namespace
+{
+const char* skipSpace(const char* s)
+{
+	while(isspace(uint8_t(*s))) {
+		++s;
+	}
+	return s;
+}
+
+bool isDigit(char c)
+{
+	return unsigned(c - '0') < 10;
+}
+
+} // namespace
+
+namespace CSV
+{
+ValueType getValueType(const char* value)
+{
+	if(value == nullptr || *skipSpace(value) == '\0') {
+		return ValueType::empty;
+	}
+	int64_t n;
+	if(parseInteger(value, n)) {
+		return ValueType::integer;
+	}
+	double d;
+	if(parseNumber(value, d)) {
+		return ValueType::number;
+	}
+	return ValueType::text;
+}
+
+bool parseInteger(const char* str, int64_t& value)
+{
+	if(str == nullptr) {
+		return false;
+	}
+	auto s = skipSpace(str);
+	bool neg = (*s == '-');
+	if(neg || *s == '+') {
+		++s;
+	}
+	if(!isDigit(*s)) {
+		return false;
+	}
+	uint64_t n{0};
+	for(; isDigit(*s); ++s) {
+		unsigned digit = *s - '0';
+		if(n > (UINT64_MAX - digit) / 10) {
+			return false;
+		}
+		n = n * 10 + digit;
+	}
+	if(*skipSpace(s) != '\0') {
+		return false;
+	}
+	if(n > uint64_t(INT64_MAX) + neg) {
+		return false;
+	}
+	value = neg ? -int64_t(n - 1) - 1 : int64_t(n);
+	return true;
+}
+
+bool parseNumber(const char* str, double& value)
+{
+	if(str == nullptr) {
+		return false;
+	}
+	auto s = skipSpace(str);
+	bool neg = (*s == '-');
+	if(neg || *s == '+') {
+		++s;
+	}
+
+	// Accumulate up to 19 significant digits, tracking decimal exponent for the rest
+	uint64_t mantissa{0};
+	int exponent{0};
+	unsigned digitCount{0};
+	auto addDigit = [&](char c, bool fraction) {
+		if(mantissa < 1000000000000000000ULL) {
+			mantissa = mantissa * 10 + unsigned(c - '0');
+			exponent -= fraction;
+		} else {
+			exponent += !fraction;
+		}
+		++digitCount;
+	};
+
+	for(; isDigit(*s); ++s) {
+		addDigit(*s, false);
+	}
+	if(*s == '.') {
+		for(++s; isDigit(*s); ++s) {
+			addDigit(*s, true);
+		}
+	}
+	if(digitCount == 0) {
+		return false;
+	}
+
+	if(*s == 'e' || *s == 'E') {
+		++s;
+		bool negexp = (*s == '-');
+		if(negexp || *s == '+') {
+			++s;
+		}
+		if(!isDigit(*s)) {
+			return false;
+		}
+		int e{0};
+		for(; isDigit(*s); ++s) {
+			if(e < 10000) {
+				e = e * 10 + (*s - '0');
+			}
+		}
+		exponent += negexp ? -e : e;
+	}
+
+	if(*skipSpace(s) != '\0') {
+		return false;
+	}
+
+	static constexpr double powers[]{1e0, 1e1, 1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+									 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+	constexpr int maxPower = sizeof(powers) / sizeof(powers[0]) - 1;
+
+	double d = mantissa;
+	if(exponent < 0) {
+		d = (exponent >= -maxPower) ? d / powers[-exponent] : d * pow(10, exponent);
+	} else if(exponent > 0) {
+		d = (exponent <= maxPower) ? d * powers[exponent] : d * pow(10, exponent);
+	}
+	value = neg ? -d : d;
+	return true;
+}
+
+} // namespace CSV
+
+String toString(CSV::ValueType type)
+{
+	switch(type) {
+	case CSV::ValueType::empty:
+		return F("empty");
+	case CSV::ValueType::integer:
+		return F("integer");
+	case CSV::ValueType::number:
+		return F("number");
+	case CSV::ValueType::text:
+	default:
+		return F("text");
+	}
+}
@@ -0,0 +1,135 @@
+/****
+ * Parallel.cpp
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include "include/CSV/Parallel.h"
+
+#ifdef ARCH_HOST
+
+#include <vector>
+
+namespace CSV
+{
+Scheduler::Scheduler(Reader& reader, const Settings& settings)
+	: reader(reader),
+	  threadCount(settings.threads ?: std::max(std::thread::hardware_concurrency(), 1U)),
+	  batchSize(std::max(settings.batchSize, 1U)), batchCount(settings.batchCount ?: 2 * threadCount),
+	  batches(new Batch[batchCount]), queues(new WorkQueue[threadCount]), freeQueue(batchCount)
+{
+}
+
+size_t Scheduler::run(ProcessBatch process)
+{
+	this->process = process;
+	pending = 0;
+	finished = false;
+	stealCount = 0;
+
+	for(unsigned i = 0; i < batchCount; ++i) {
+		freeQueue.push(&batches[i]);
+	}
+
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount);
+	for(unsigned i = 0; i < threadCount; ++i) {
+		threads.emplace_back(&Scheduler::worker, this, i);
+	}
+
+	size_t recordCount{0};
+	for(unsigned seq = 0;; ++seq) {
+		auto batch = freeQueue.pop();
+		auto count = batch->fill(reader, batchSize);
+		if(count == 0) {
+			freeQueue.push(batch);
+			break;
+		}
+		batch->sequence = seq;
+		recordCount += count;
+		++pending;
+		auto& queue = queues[seq % threadCount];
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.batches.push_back(batch);
+		}
+		if(count < batchSize) {
+			break;
+		}
+	}
+
+	finished.store(true, std::memory_order_release);
+	for(auto& thread : threads) {
+		thread.join();
+	}
+
+	// Return pool to initial state
+	Batch* batch;
+	while(freeQueue.tryPop(batch)) {
+	}
+
+	return recordCount;
+}
+
+Batch* Scheduler::take(unsigned index)
+{
+	// Own queue: newest first, as its rows are most likely to be in cache
+	auto& own = queues[index];
+	{
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if(!own.batches.empty()) {
+			auto batch = own.batches.back();
+			own.batches.pop_back();
+			return batch;
+		}
+	}
+
+	// Steal oldest batch from another worker
+	for(unsigned i = 1; i < threadCount; ++i) {
+		auto& victim = queues[(index + i) % threadCount];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if(!victim.batches.empty()) {
+			auto batch = victim.batches.front();
+			victim.batches.pop_front();
+			++stealCount;
+			return batch;
+		}
+	}
+
+	return nullptr;
+}
+
+void Scheduler::worker(unsigned index)
+{
+	for(;;) {
+		auto batch = take(index);
+		if(batch == nullptr) {
+			// Reader sets `finished` after queueing final batch
+			if(finished.load(std::memory_order_acquire) && pending.load(std::memory_order_acquire) == 0) {
+				break;
+			}
+			std::this_thread::yield();
+			continue;
+		}
+		--pending;
+		process(index, *batch);
+		freeQueue.push(batch);
+	}
+}
+
+} // namespace CSV
+
+#endif // ARCH_HOST
@@ -18,6 +18,7 @@
  ****/
 
 #include "include/CSV/Parser.h"
+#include "include/CSV/Hash.h"
 #include <Data/Stream/LimitedMemoryStream.h>
 #include <debug_progmem.h>
 
@@ -32,11 +33,46 @@ namespace CSV
  */
 static const size_t READ_OFFSET = 1;
 
+void Parser::initCharClass()
+{
+	memset(charClass, 0, sizeof(charClass));
+
+	auto set = [&](char c, uint8_t cls) { charClass[uint8_t(c)] |= cls; };
+	auto setList = [&](const char* list, uint8_t cls) {
+		if(list) {
+			for(; *list; ++list) {
+				set(*list, cls);
+			}
+		}
+	};
+
+	// Fields separated by whitespace and ignore leading/trailing whitespace
+	if(options.fieldSeparator == '\0') {
+		for(unsigned c = 0; c < 256; ++c) {
+			if(isspace(c)) {
+				charClass[c] |= cls_space | cls_separator;
+			}
+		}
+	}
+	set(options.fieldSeparator, cls_separator);
+	setList(options.fieldSeparators, cls_separator);
+	setList(options.commentChars, cls_comment);
+	if(options.quoteChar) {
+		set(options.quoteChar, cls_quote);
+	}
+	if(options.parseEscape) {
+		set('\\', cls_escape);
+	}
+	set('\n', cls_newline);
+	set('\r', cls_return);
+}
+
 bool Parser::push(Stream& source)
 {
 	for(;;) {
+		// Wait until a complete record is available
 		auto len = fillBuffer(&source);
-		if(len < options.lineLength) {
+		if(len < getBufferSize() - READ_OFFSET && !hasRecord()) {
 			return false;
 		}
 		if(!parseRow(false)) {
@@ -75,7 +111,7 @@ bool Parser::readRow(IDataSourceStream& source)
 	for(;;) {
 		auto len = fillBuffer(&source);
 		bool eof = source.isFinished();
-		if(!eof && len < options.lineLength) {
+		if(!eof && len < getBufferSize() - READ_OFFSET && !hasRecord()) {
 			return false;
 		}
 		if(!parseRow(eof)) {
@@ -98,12 +134,152 @@ void Parser::reset(int offset)
 	cursor = {offset};
 	sourcePos = std::max(offset, 0);
 	taillen = 0;
+	scan = {};
+	fieldHashes.clear();
+	rowHash = 0;
 }
 
-size_t Parser::fillBuffer(Stream* source)
+bool Parser::skipBuffered(unsigned pos, unsigned streamPos)
+{
+	if(streamPos != sourcePos || pos > sourcePos) {
+		return false;
+	}
+	unsigned remain = sourcePos - pos;
+	if(buffer) {
+		// Data pushed but not yet parsed
+		unsigned len = buffer.length() - READ_OFFSET;
+		if(remain > len) {
+			return false;
+		}
+		auto bufptr = buffer.begin() + READ_OFFSET;
+		memmove(bufptr, bufptr + len - remain, remain);
+		buffer.setLength(READ_OFFSET + remain);
+		scan = {};
+	} else {
+		// Unparsed data following current row
+		if(remain > taillen) {
+			return false;
+		}
+		tailpos += taillen - remain;
+		taillen = remain;
+	}
+	return true;
+}
+
+void Parser::setRow(const CStringArray& newRow, const Cursor& newCursor, unsigned nextPos)
+{
+	reset(nextPos);
+	row = newRow;
+	cursor = newCursor;
+	if(options.hashFields) {
+		hashRow();
+	}
+}
+
+/*
+ * Hashing is a separate pass over the completed row, rather than being done as each field is produced,
+ * as rows are also set from the record cache and are then not parsed.
+ * The row has just been written so is normally in the data cache.
+ * Field hash storage is retained between rows so this does not allocate once it has grown to the field count.
+ */
+void Parser::hashRow()
+{
+	// Fields are stored consecutively, each NUL-terminated
+	unsigned count = row.count();
+	fieldHashes.resize(count);
+	auto ptr = row.c_str();
+	for(unsigned i = 0; i < count; ++i) {
+		auto len = strlen(ptr);
+		fieldHashes[i] = xxh32(ptr, len);
+		ptr += len + 1;
+	}
+	rowHash = xxh32(fieldHashes.data(), count * sizeof(uint32_t));
+}
+
+Parser::Checkpoint Parser::getCheckpoint() const
+{
+	Checkpoint checkpoint{cursor, sourcePos};
+	if(buffer) {
+		// Data pushed but not yet enough for a complete row
+		checkpoint.pending = String(buffer.c_str() + READ_OFFSET, buffer.length() - READ_OFFSET);
+	} else if(taillen != 0) {
+		// Unparsed data following current row
+		checkpoint.pending = String(row.c_str() + tailpos, taillen);
+	}
+	return checkpoint;
+}
+
+bool Parser::restore(const Checkpoint& checkpoint)
+{
+	auto pendingLength = checkpoint.pending.length();
+	if(pendingLength > checkpoint.sourcePos || READ_OFFSET + pendingLength > getBufferSize()) {
+		return false;
+	}
+
+	if(!buffer) {
+		buffer = row.release();
+	}
+	if(!buffer.reserve(getBufferSize())) {
+		debug_e("[CSV] Out of memory %u", getBufferSize());
+		return false;
+	}
+	buffer.setLength(READ_OFFSET);
+	buffer.concat(checkpoint.pending.c_str(), pendingLength);
+	cursor = checkpoint.cursor;
+	sourcePos = checkpoint.sourcePos;
+	taillen = 0;
+	scan = {};
+	return true;
+}
+
+bool Parser::Checkpoint::save(Print& out) const
+{
+	struct {
+		int32_t start;
+		uint32_t end;
+		uint32_t sourcePos;
+		uint32_t pendingLength;
+	} hdr{cursor.start, cursor.end, sourcePos, uint32_t(pending.length())};
+	if(out.write(reinterpret_cast<const uint8_t*>(&hdr), sizeof(hdr)) != sizeof(hdr)) {
+		return false;
+	}
+	return out.write(reinterpret_cast<const uint8_t*>(pending.c_str()), pending.length()) == pending.length();
+}
+
+bool Parser::Checkpoint::load(Stream& in)
+{
+	struct {
+		int32_t start;
+		uint32_t end;
+		uint32_t sourcePos;
+		uint32_t pendingLength;
+	} hdr;
+	if(in.readBytes(reinterpret_cast<char*>(&hdr), sizeof(hdr)) != sizeof(hdr)) {
+		return false;
+	}
+	if(hdr.pendingLength > hdr.sourcePos || hdr.pendingLength > UINT16_MAX) {
+		return false;
+	}
+	if(!pending.setLength(hdr.pendingLength)) {
+		return false;
+	}
+	if(in.readBytes(pending.begin(), hdr.pendingLength) != hdr.pendingLength) {
+		return false;
+	}
+	cursor = {hdr.start, hdr.end};
+	sourcePos = hdr.sourcePos;
+	return true;
+}
+
+size_t Parser::getBufferSize() const
 {
 	const size_t minBufSize{512};
-	const size_t maxbuflen = std::max(minBufSize, READ_OFFSET + options.lineLength + 2);
+	return std::max(minBufSize, READ_OFFSET + options.lineLength + 2);
+}
+
+size_t Parser::fillBuffer(Stream* source)
+{
+	const size_t maxbuflen = getBufferSize();
 
 	char* bufptr;
 	size_t buflen;
@@ -129,6 +305,7 @@ size_t Parser::fillBuffer(Stream* source)
 		}
 		buflen = READ_OFFSET + taillen;
 		taillen = 0;
+		scan = {};
 	}
 
 	if(source) {
@@ -143,13 +320,103 @@ size_t Parser::fillBuffer(Stream* source)
 	return buflen - READ_OFFSET;
 }
 
-bool Parser::parseRow(bool eof)
+/*
+ * Determine if buffered data contains a complete record, so it can be parsed before the buffer is full.
+ * Escapes and whitespace separators are not analysed: return false so the caller waits for more data.
+ * Otherwise quote and comment state is tracked exactly as by `parseRow()`.
+ * Scanning resumes where the previous call stopped, so data is only examined once per record.
+ */
+bool Parser::hasRecord()
 {
-	constexpr char quoteChar{'"'};
+	// Line breaks are skipped at the start of whitespace-separated fields
+	if(options.fieldSeparator == ' ') {
+		return false;
+	}
 
-	// Fields separated by whitespace and ignore leading/trailing whitespace
-	bool wssep = (options.fieldSeparator == '\0');
+	auto start = buffer.c_str() + READ_OFFSET;
+	auto end = buffer.c_str() + buffer.length();
+	for(auto ptr = start + scan.pos; ptr < end; ++ptr) {
+		auto cls = charClass[uint8_t(*ptr)];
+		if(cls & cls_newline) {
+			if(scan.comment || !scan.quote) {
+				return true;
+			}
+		} else if(scan.comment) {
+			continue;
+		} else if(cls & cls_escape) {
+			scan.pos = ptr - start;
+			return false;
+		} else if((cls & cls_comment) && !scan.inField) {
+			// Comment runs to end of line, quotes within it are ignored
+			scan.comment = true;
+			continue;
+		} else if(cls & cls_quote) {
+			scan.quote = !scan.quote;
+		} else if((cls & cls_separator) && !scan.quote) {
+			scan.inField = false;
+			continue;
+		}
+		scan.inField = true;
+	}
+	scan.pos = end - start;
+	return false;
+}
+
+/*
+ * Fast path for records containing no quotes, escapes, comments or embedded carriage returns.
+ * Locate end of record then check content: if anything requires the full parser
+ * then return false without modifying the buffer.
+ */
+bool Parser::parseUnquoted(unsigned& readpos, unsigned& writepos)
+{
+	// Whitespace separators require skipping of repeated whitespace
+	if(options.fieldSeparator == '\0') {
+		return false;
+	}
+
+	auto bufptr = buffer.begin();
+	auto start = bufptr + READ_OFFSET;
+	auto bufend = bufptr + buffer.length();
+	auto newline = static_cast<char*>(memchr(start, '\n', bufend - start));
+	auto end = newline ?: bufend;
+	size_t len = end - start;
+	if(newline && len != 0 && end[-1] == '\r') {
+		--len;
+	}
+
+	const uint8_t special = cls_quote | cls_escape | cls_comment | cls_space | cls_return;
+	for(size_t i = 0; i < len; ++i) {
+		if(charClass[uint8_t(start[i])] & special) {
+			return false;
+		}
+	}
+
+	// Shift data down and replace separators
+	memmove(bufptr, start, len);
+	if(options.fieldSeparators == nullptr) {
+		auto ptr = bufptr;
+		auto ptrEnd = bufptr + len;
+		while((ptr = static_cast<char*>(memchr(ptr, options.fieldSeparator, ptrEnd - ptr))) != nullptr) {
+			*ptr++ = '\0';
+		}
+	} else {
+		for(size_t i = 0; i < len; ++i) {
+			if(charClass[uint8_t(bufptr[i])] & cls_separator) {
+				bufptr[i] = '\0';
+			}
+		}
+	}
 
+	readpos = end - bufptr;
+	writepos = len;
+	if(newline) {
+		cursor.end = cursor.start + readpos - READ_OFFSET;
+	}
+	return true;
+}
+
+bool Parser::parseRow(bool eof)
+{
 	/*
 	 * Ensure readpos > writepos.
 	 * Row data is always <= source length, but when result is converted (in-situ) to CStringArray
@@ -158,6 +425,11 @@ bool Parser::parseRow(bool eof)
 	unsigned writepos = 0;
 	unsigned readpos = READ_OFFSET;
 
+	auto bufptr = buffer.begin();
+	auto buflen = buffer.length();
+
+	cursor = {int(sourcePos + READ_OFFSET - buflen)};
+
 	struct Flags {
 		bool escape : 1;
 		bool quote : 1;
@@ -175,89 +447,87 @@ bool Parser::parseRow(bool eof)
 
 	char lastChar{'\0'};
 
-	auto bufptr = buffer.begin();
-	auto buflen = buffer.length();
-
-	cursor = {int(sourcePos + READ_OFFSET - buflen)};
-
-	for(; readpos < buflen; ++readpos) {
-		char c = bufptr[readpos];
-		if(flags.comment) {
-			if(c == '\n') {
-				flags.comment = false;
-				cursor.end = cursor.start + readpos - READ_OFFSET;
-				break;
-			}
-			if(options.wantComments) {
-				bufptr[writepos++] = c;
-			}
-			continue;
-		}
-		if(flags.escape) {
-			switch(c) {
-			case 'n':
-				c = '\n';
-				break;
-			case 'r':
-				c = '\r';
-				break;
-			case 't':
-				c = '\t';
-				break;
-			default:;
-				// Just accept character
-			}
-			flags.escape = false;
-		} else {
-			if(fieldKind == FieldKind::unknown) {
-				if(wssep && isspace(c)) {
-					continue;
-				}
-				if(options.commentChars && strchr(options.commentChars, c)) {
-					flags.comment = true;
-					if(options.wantComments) {
-						bufptr[writepos++] = c;
-					}
-					continue;
+	if(!options.fastPath || !parseUnquoted(readpos, writepos)) {
+		for(; readpos < buflen; ++readpos) {
+			char c = bufptr[readpos];
+			auto cls = charClass[uint8_t(c)];
+			if(flags.comment) {
+				if(cls & cls_newline) {
+					flags.comment = false;
+					cursor.end = cursor.start + readpos - READ_OFFSET;
+					break;
 				}
-				if(c == quoteChar) {
-					fieldKind = FieldKind::quoted;
-					flags.quote = true;
-					lastChar = '\0';
-					continue;
+				if(options.wantComments) {
+					bufptr[writepos++] = c;
 				}
-				fieldKind = FieldKind::unquoted;
+				continue;
 			}
-			if(c == quoteChar) {
-				flags.quote = !flags.quote;
-				if(fieldKind == FieldKind::quoted) {
-					if(lastChar == quoteChar) {
-						buffer[writepos++] = c;
+			if(flags.escape) {
+				switch(c) {
+				case 'n':
+					c = '\n';
+					break;
+				case 'r':
+					c = '\r';
+					break;
+				case 't':
+					c = '\t';
+					break;
+				default:;
+					// Just accept character
+				}
+				flags.escape = false;
+			} else {
+				if(fieldKind == FieldKind::unknown) {
+					if(cls & cls_space) {
+						continue;
+					}
+					if(cls & cls_comment) {
+						flags.comment = true;
+						if(options.wantComments) {
+							bufptr[writepos++] = c;
+						}
+						continue;
+					}
+					if(cls & cls_quote) {
+						fieldKind = FieldKind::quoted;
+						flags.quote = true;
 						lastChar = '\0';
-					} else {
-						lastChar = c;
+						continue;
 					}
-					continue;
+					fieldKind = FieldKind::unquoted;
 				}
-			} else if(c == '\\' && options.parseEscape) {
-				flags.escape = true;
-				continue;
-			} else if(!flags.quote) {
-				if(c == '\r') {
+				if(cls & cls_quote) {
+					flags.quote = !flags.quote;
+					if(fieldKind == FieldKind::quoted) {
+						if(lastChar == c) {
+							buffer[writepos++] = c;
+							lastChar = '\0';
+						} else {
+							lastChar = c;
+						}
+						continue;
+					}
+				} else if(cls & cls_escape) {
+					flags.escape = true;
+					continue;
+				} else if(!flags.quote) {
+					if(cls & cls_return) {
+						continue;
+					} else if(cls & cls_newline) {
+						cursor.end = cursor.start + readpos - READ_OFFSET;
+						break;
+					} else if(cls & cls_separator) {
+						c = '\0';
+						fieldKind = FieldKind::unknown;
+					}
+				} else if(cls & cls_space) {
 					continue;
-				} else if(c == '\n') {
-					cursor.end = cursor.start + readpos - READ_OFFSET;
-					break;
-				} else if((wssep && isspace(c)) || c == options.fieldSeparator) {
-					c = '\0';
-					fieldKind = FieldKind::unknown;
 				}
-			} else if(wssep && isspace(c)) {
-				continue;
 			}
+			bufptr[writepos++] = c;
+			lastChar = c;
 		}
-		bufptr[writepos++] = c;
-		lastChar = c;
 	}
 
 	if(readpos < buflen) {
@@ -283,6 +553,10 @@ bool Parser::parseRow(bool eof)
 		return !eof || readpos < buflen;
 	}
 
+	if(options.hashFields) {
+		hashRow();
+	}
+
 	return true;
 }
 
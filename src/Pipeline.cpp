@@ -0,0 +1,127 @@
+/****
+ * Pipeline.cpp
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include "include/CSV/Pipeline.h"
+
+#ifdef ARCH_HOST
+
+#include <vector>
+
+namespace
+{
+unsigned getThreadCount(unsigned threads)
+{
+	if(threads != 0) {
+		return threads;
+	}
+	return std::max(std::thread::hardware_concurrency(), 1U);
+}
+
+} // namespace
+
+namespace CSV
+{
+Pipeline::Pipeline(Reader& reader, const Settings& settings)
+	: reader(reader), threadCount(::getThreadCount(settings.threads)), batchSize(std::max(settings.batchSize, 1U)),
+	  batchCount(settings.batchCount ?: 2 * threadCount), batches(new Batch[batchCount]), freeQueue(batchCount),
+	  fullQueue(batchCount + threadCount)
+{
+}
+
+size_t Pipeline::run(ProcessBatch process, CompleteBatch complete)
+{
+	this->process = process;
+	this->complete = complete;
+	nextComplete = 0;
+
+	for(unsigned i = 0; i < batchCount; ++i) {
+		freeQueue.push(&batches[i]);
+	}
+
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount);
+	for(unsigned i = 0; i < threadCount; ++i) {
+		threads.emplace_back(&Pipeline::worker, this, i);
+	}
+
+	size_t recordCount{0};
+	for(unsigned seq = 0;; ++seq) {
+		auto batch = freeQueue.pop();
+		auto count = batch->fill(reader, batchSize);
+		if(count == 0) {
+			freeQueue.push(batch);
+			break;
+		}
+		batch->sequence = seq;
+		recordCount += count;
+		fullQueue.push(batch);
+		if(count < batchSize) {
+			break;
+		}
+	}
+
+	// Null batch tells worker to quit
+	for(unsigned i = 0; i < threadCount; ++i) {
+		fullQueue.push(nullptr);
+	}
+	for(auto& thread : threads) {
+		thread.join();
+	}
+
+	// Return pool to initial state
+	Batch* batch;
+	while(freeQueue.tryPop(batch)) {
+	}
+
+	return recordCount;
+}
+
+void Pipeline::worker(unsigned index)
+{
+	Batch* batch;
+	while((batch = fullQueue.pop()) != nullptr) {
+		process(index, *batch);
+		if(complete) {
+			waitTurn(batch->sequence);
+			complete(*batch);
+			{
+				std::lock_guard<std::mutex> lock(completeMutex);
+				nextComplete.store(batch->sequence + 1, std::memory_order_release);
+			}
+			completeSignal.notify_all();
+		}
+		freeQueue.push(batch);
+	}
+}
+
+void Pipeline::waitTurn(unsigned sequence)
+{
+	// Usually the preceding batch is nearly done, so check a few times before sleeping
+	for(unsigned i = 0; i < 64; ++i) {
+		if(nextComplete.load(std::memory_order_acquire) == sequence) {
+			return;
+		}
+	}
+	std::unique_lock<std::mutex> lock(completeMutex);
+	completeSignal.wait(lock, [&]() { return nextComplete.load(std::memory_order_acquire) == sequence; });
+}
+
+} // namespace CSV
+
+#endif // ARCH_HOST
@@ -0,0 +1,169 @@
+/****
+ * Profiler.cpp
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include "include/CSV/Profiler.h"
+#include "include/CSV/Hash.h"
+#include <algorithm>
+#include <cmath>
+
+namespace CSV
+{
+void LengthHistogram::add(size_t length)
+{
+	unsigned bin{0};
+	if(length >= (1U << (binCount - 2))) {
+		bin = binCount - 1;
+	} else if(length != 0) {
+		bin = 32 - __builtin_clz(length);
+	}
+	++bins[bin];
+	if(count == 0) {
+		min = max = length;
+	} else {
+		min = std::min(min, uint32_t(length));
+		max = std::max(max, uint32_t(length));
+	}
+	++count;
+}
+
+void LengthHistogram::merge(const LengthHistogram& other)
+{
+	if(other.count == 0) {
+		return;
+	}
+	if(count == 0) {
+		*this = other;
+		return;
+	}
+	for(unsigned i = 0; i < binCount; ++i) {
+		bins[i] += other.bins[i];
+	}
+	count += other.count;
+	min = std::min(min, other.min);
+	max = std::max(max, other.max);
+}
+
+size_t LengthHistogram::getLength(float fraction) const
+{
+	uint32_t target = ceil(std::min(std::max(fraction, 0.0f), 1.0f) * count);
+	uint32_t total{0};
+	for(unsigned i = 0; i < binCount - 1; ++i) {
+		total += bins[i];
+		if(total >= target) {
+			return std::min((1U << i) - 1, max);
+		}
+	}
+	return max;
+}
+
+ValueType Profiler::Column::getType() const
+{
+	for(unsigned i = valueTypeCount - 1; i > 0; --i) {
+		if(typeCounts[i] != 0) {
+			return ValueType(i);
+		}
+	}
+	return ValueType::empty;
+}
+
+void Profiler::add(const Batch& batch)
+{
+	for(unsigned i = 0; i < batch.count(); ++i) {
+		addRow(batch[i], batch.getCursor(i).length(), nullptr);
+	}
+}
+
+size_t Profiler::run(Reader& reader)
+{
+	auto hashReader = reader.getOptions().hashFields ? &reader : nullptr;
+	size_t count{0};
+	while(reader.next()) {
+		addRow(reader.getRow(), reader.getCursor().length(), hashReader);
+		++count;
+	}
+	return count;
+}
+
+void Profiler::addColumns(unsigned count)
+{
+	// Records seen before these columns appeared did not contain them
+	while(columns.size() < count) {
+		columns.emplace_back(precision);
+		columns.back().nullCount = recordCount;
+	}
+}
+
+void Profiler::addRow(const CStringArray& row, size_t recordLength, const Reader* reader)
+{
+	addColumns(row.count());
+
+	unsigned i{0};
+	for(auto value : row) {
+		auto& col = columns[i];
+		auto length = strlen(value);
+		col.lengths.add(length);
+		auto type = getValueType(value);
+		++col.typeCounts[unsigned(type)];
+		if(type != ValueType::empty) {
+			col.distinct.addHash(reader ? reader->getFieldHash(i) : xxh32(value, length));
+		}
+		++col.numbers.count;
+		if(type == ValueType::integer || type == ValueType::number) {
+			double n;
+			if(parseNumber(value, n)) {
+				col.numbers.addValue(n);
+			}
+		}
+		++i;
+	}
+	for(; i < columns.size(); ++i) {
+		++columns[i].nullCount;
+	}
+
+	recordLengths.add(recordLength);
+	++recordCount;
+}
+
+bool Profiler::merge(const Profiler& other)
+{
+	if(other.precision != precision) {
+		return false;
+	}
+	addColumns(other.columns.size());
+	for(unsigned i = 0; i < columns.size(); ++i) {
+		auto& col = columns[i];
+		if(i >= other.columns.size()) {
+			col.nullCount += other.recordCount;
+			continue;
+		}
+		auto& src = other.columns[i];
+		col.nullCount += src.nullCount;
+		for(unsigned t = 0; t < valueTypeCount; ++t) {
+			col.typeCounts[t] += src.typeCounts[t];
+		}
+		col.numbers.merge(src.numbers);
+		col.lengths.merge(src.lengths);
+		col.distinct.merge(src.distinct);
+	}
+	recordLengths.merge(other.recordLengths);
+	recordCount += other.recordCount;
+	return true;
+}
+
+} // namespace CSV
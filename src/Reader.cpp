@@ -18,6 +18,7 @@
  ****/
 
 #include "include/CSV/Reader.h"
+#include <debug_progmem.h>
 
 namespace CSV
 {
@@ -25,28 +26,174 @@ Reader::Reader(IDataSourceStream* source, const Options& options, const CStringA
 	: Parser(options), source(source), headings(headings)
 {
 	if(source && !headings) {
+		sourceHeadings = true;
 		readRow(*source);
 		this->headings = getRow();
 		start = getStreamPos();
 	}
 }
 
-bool Reader::seek(int offset)
+bool Reader::setSource(IDataSourceStream* newSource)
 {
+	source.reset(newSource);
+	Parser::reset();
+	start = 0;
+	if(cache) {
+		cache->clear();
+	}
 	if(!source) {
 		return false;
 	}
-	int newpos = std::max(offset, int(start));
-	int pos = source->seekFrom(newpos, SeekOrigin::Start);
-	if(pos != newpos) {
+	if(!sourceHeadings) {
+		return true;
+	}
+	readRow(*source);
+	auto& row = getRow();
+	if(row.length() != headings.length() || memcmp(row.c_str(), headings.c_str(), row.length()) != 0) {
+		debug_e("[CSV] Headings mismatch in '%s'", source->getName().c_str());
+		source.reset();
 		return false;
 	}
-	Parser::reset(newpos);
-	if(offset < int(start)) {
-		// Before first record has been read
-		return true;
+	start = getStreamPos();
+	return true;
+}
+
+bool Reader::seek(int offset, bool useCache)
+{
+	if(!source) {
+		return false;
+	}
+	useCache = useCache && cache;
+	if(useCache && offset >= int(start)) {
+		auto entry = cache->find(offset);
+		if(entry) {
+			int nextPos = entry->nextPos;
+			if(source->seekFrom(nextPos, SeekOrigin::Start) != nextPos) {
+				return false;
+			}
+			setRow(entry->row, entry->cursor, nextPos);
+			return true;
+		}
+	}
+	// Target may already be buffered, such as the following record
+	bool ok;
+	if(offset >= int(start) && skipBuffered(offset, source->seekFrom(0, SeekOrigin::Current))) {
+		ok = readRow(*source);
+	} else {
+		int newpos = std::max(offset, int(start));
+		int pos = source->seekFrom(newpos, SeekOrigin::Start);
+		if(pos != newpos) {
+			return false;
+		}
+		Parser::reset(newpos);
+		if(offset < int(start)) {
+			// Before first record has been read
+			return true;
+		}
+		ok = readRow(*source);
+	}
+	if(ok && useCache && getCursor().start == offset) {
+		cache->add(getCursor(), getStreamPos(), getRow());
+	}
+	return ok;
+}
+
+bool Reader::prev()
+{
+	if(!source) {
+		return false;
+	}
+	if(getRow().length() == 0 && tell() > int(start)) {
+		// Past last record
+		return last();
+	}
+	return seekPrevious(tell());
+}
+
+bool Reader::last()
+{
+	return source ? seekPrevious(source->seekFrom(0, SeekOrigin::End)) : false;
+}
+
+bool Reader::seekPrevious(int target)
+{
+	int pos = (target < 0) ? BOF : findPrevious(target);
+	if(pos < 0) {
+		reset();
+		return false;
+	}
+	return seek(pos, false);
+}
+
+/*
+ * Find start of record preceding target, which is either the start of a record or end of data.
+ *
+ * Scanning backwards, the quote state at target is known to be 'outside', so a line break
+ * is only considered if there are an even number of quotes between it and the target.
+ */
+int Reader::findPrevious(unsigned target)
+{
+	if(target <= start) {
+		return BOF;
+	}
+
+	const char quoteChar = getOptions().quoteChar;
+	bool inQuote{false};
+	char buf[64];
+	unsigned end = target;
+	while(end > start) {
+		unsigned len = std::min(end - start, unsigned(sizeof(buf)));
+		unsigned blockStart = end - len;
+		if(source->seekFrom(blockStart, SeekOrigin::Start) != int(blockStart)) {
+			return BOF;
+		}
+		if(source->readBytes(buf, len) != len) {
+			return BOF;
+		}
+		for(unsigned i = len; i-- != 0;) {
+			char c = buf[i];
+			if(c == quoteChar && quoteChar != '\0') {
+				inQuote = !inQuote;
+				continue;
+			}
+			if(c != '\n' || inQuote) {
+				continue;
+			}
+			unsigned candidate = blockStart + i + 1;
+			if(candidate >= target) {
+				continue;
+			}
+			int pos = checkBoundary(candidate, target);
+			if(pos >= 0) {
+				return pos;
+			}
+		}
+		end = blockStart;
+	}
+
+	return checkBoundary(start, target);
+}
+
+/*
+ * Parse forward from possible record boundary.
+ * If this arrives exactly at target, return start of the record preceding it.
+ */
+int Reader::checkBoundary(unsigned pos, unsigned target)
+{
+	int prevStart{BOF};
+	bool ok = seek(pos, false);
+	while(ok && unsigned(tell()) < target) {
+		prevStart = tell();
+		ok = next();
+	}
+	if(prevStart < 0) {
+		return BOF;
+	}
+	if(ok) {
+		return (unsigned(tell()) == target) ? prevStart : BOF;
 	}
-	return readRow(*source);
+	// Reached end of data
+	return (target >= getStreamPos()) ? prevStart : BOF;
 }
 
 } // namespace CSV
@@ -0,0 +1,68 @@
+/****
+ * RecordCache.cpp
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include "include/CSV/RecordCache.h"
+#include <algorithm>
+
+namespace CSV
+{
+const RecordCache::Entry* RecordCache::find(int start)
+{
+	for(auto& entry : entries) {
+		if(entry.cursor.start == start) {
+			++hitCount;
+			entry.lastUse = ++useCount;
+			return &entry;
+		}
+	}
+	++missCount;
+	return nullptr;
+}
+
+bool RecordCache::add(const Cursor& cursor, unsigned nextPos, const CStringArray& row)
+{
+	auto size = getEntrySize(row);
+	if(size > maxBytes) {
+		return false;
+	}
+	while(usedBytes + size > maxBytes) {
+		evict();
+	}
+	Entry entry{cursor, nextPos, ++useCount, row};
+	if(entry.row.length() != row.length()) {
+		// Out of memory
+		return false;
+	}
+	entries.push_back(std::move(entry));
+	usedBytes += size;
+	return true;
+}
+
+void RecordCache::evict()
+{
+	auto it = std::min_element(entries.begin(), entries.end(),
+							   [](const Entry& e1, const Entry& e2) { return e1.lastUse < e2.lastUse; });
+	usedBytes -= getEntrySize(it->row);
+	if(it != entries.end() - 1) {
+		*it = std::move(entries.back());
+	}
+	entries.pop_back();
+}
+
+} // namespace CSV
@@ -0,0 +1,320 @@
+/****
+ * Sniffer.cpp
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include "include/CSV/Sniffer.h"
+#include <algorithm>
+
+namespace
+{
+using namespace CSV;
+
+constexpr unsigned maxSampleRecords{64};
+
+// Candidate separators in order of preference, '\0' for whitespace
+constexpr char separators[]{',', '\t', ';', '|', '\0'};
+
+// Candidate comment characters, string literals so they can be used in Options
+const char* const commentChars[]{"#", ";", "%"};
+
+using Rows = std::vector<CStringArray>;
+
+/*
+ * A quote character starts or ends a field so must be next to a separator or line break.
+ * Doubled quotes are accepted, as these are either escaped or an empty quoted field.
+ * Apostrophes within unquoted values, such as "O'Brien", disqualify the character.
+ */
+bool isQuoteChar(const String& sample, char quote)
+{
+	auto isBoundary = [](char c) { return c == ' ' || c == '\r' || c == '\n' || strchr(separators, c) != nullptr; };
+
+	auto data = sample.c_str();
+	auto length = sample.length();
+	bool found{false};
+	for(size_t i = 0; i < length; ++i) {
+		if(data[i] != quote) {
+			continue;
+		}
+		if(i + 1 < length && data[i + 1] == quote) {
+			++i;
+			continue;
+		}
+		char prev = (i == 0) ? '\n' : data[i - 1];
+		char next = (i + 1 == length) ? '\n' : data[i + 1];
+		if(!isBoundary(prev) && !isBoundary(next)) {
+			return false;
+		}
+		found = true;
+	}
+	return found;
+}
+
+void parseSample(const String& sample, const Parser::Options& options, Rows& rows)
+{
+	rows.clear();
+	Parser parser(options);
+	size_t offset{0};
+	auto add = [&]() {
+		if(rows.size() < maxSampleRecords) {
+			rows.push_back(parser.getRow());
+		}
+	};
+	while(parser.push(sample.c_str(), sample.length(), offset)) {
+		add();
+	}
+	while(parser.flush()) {
+		add();
+	}
+}
+
+/*
+ * Score how consistent the number of fields is, 0 if records don't have at least two fields.
+ * A separator which doesn't appear in every record is penalised.
+ */
+float scoreRows(const Rows& rows)
+{
+	if(rows.empty()) {
+		return 0;
+	}
+	// Find most common field count
+	unsigned modeCount{0};
+	unsigned modeFreq{0};
+	unsigned multiFieldCount{0};
+	for(auto& row : rows) {
+		unsigned count = row.count();
+		if(count > 1) {
+			++multiFieldCount;
+		}
+		unsigned freq = std::count_if(rows.begin(), rows.end(), [&](auto& r) { return r.count() == count; });
+		if(freq > modeFreq || (freq == modeFreq && count > modeCount)) {
+			modeCount = count;
+			modeFreq = freq;
+		}
+	}
+	if(modeCount < 2) {
+		return 0;
+	}
+	return float(modeFreq) * multiFieldCount / (rows.size() * rows.size());
+}
+
+/*
+ * Find comment character: must start at least one line but not appear in most others
+ */
+const char* findCommentChars(const String& sample)
+{
+	for(auto chars : commentChars) {
+		char c = *chars;
+		unsigned commentLines{0};
+		unsigned otherLines{0};
+		unsigned containing{0};
+		bool lineStart{true};
+		bool skip{false}; // Ignore rest of line
+		for(auto ch : sample) {
+			if(lineStart) {
+				lineStart = false;
+				skip = (ch == c);
+				if(skip) {
+					++commentLines;
+				} else {
+					++otherLines;
+				}
+			}
+			if(ch == '\n') {
+				lineStart = true;
+			} else if(ch == c && !skip) {
+				skip = true;
+				++containing;
+			}
+		}
+		if(commentLines != 0 && containing * 2 < otherLines) {
+			return chars;
+		}
+	}
+	return nullptr;
+}
+
+/*
+ * Vote on whether first record contains headings, based on Python csv.Sniffer.has_header()
+ */
+bool detectHeadings(const Rows& rows, const std::vector<ValueType>& bodyTypes)
+{
+	if(rows.size() < 2) {
+		return false;
+	}
+	auto& first = rows[0];
+	int votes{0};
+	for(unsigned col = 0; col < bodyTypes.size(); ++col) {
+		auto value = first[col];
+		if(value == nullptr || *value == '\0') {
+			// Headings are never empty
+			return false;
+		}
+		auto type = bodyTypes[col];
+		if(type == ValueType::integer || type == ValueType::number) {
+			votes += (getValueType(value) == ValueType::text) ? 1 : -1;
+			continue;
+		}
+		// For text columns of fixed width, a heading of different width is a good indicator
+		size_t len{0};
+		bool fixed{true};
+		for(unsigned i = 1; i < rows.size(); ++i) {
+			auto v = rows[i][col];
+			auto n = v ? strlen(v) : 0;
+			if(i == 1) {
+				len = n;
+			} else if(n != len) {
+				fixed = false;
+				break;
+			}
+		}
+		if(fixed) {
+			votes += (strlen(value) != len) ? 1 : -1;
+		}
+	}
+	return votes > 0;
+}
+
+} // namespace
+
+namespace CSV
+{
+bool Sniffer::sniff(IDataSourceStream& source, Result& result, size_t sampleSize)
+{
+	result = Result{};
+
+	int startPos = source.seekFrom(0, SeekOrigin::Current);
+	if(startPos < 0) {
+		return false;
+	}
+	String sample;
+	if(!sample.setLength(sampleSize)) {
+		return false;
+	}
+	auto len = source.readBytes(sample.begin(), sampleSize);
+	bool complete = source.isFinished();
+	if(source.seekFrom(startPos, SeekOrigin::Start) != startPos) {
+		return false;
+	}
+	sample.setLength(len);
+
+	// Discard any partial line at end
+	if(!complete) {
+		int lastLine = sample.lastIndexOf('\n');
+		if(lastLine < 0) {
+			return false;
+		}
+		sample.setLength(lastLine + 1);
+	}
+
+	result.crlf = (sample.indexOf('\r') >= 0);
+
+	// Size line buffer to accommodate longest line with room to spare
+	size_t maxLineLength{0};
+	for(int pos = 0; unsigned(pos) < sample.length();) {
+		int next = sample.indexOf('\n', pos);
+		if(next < 0) {
+			next = sample.length();
+		}
+		maxLineLength = std::max(maxLineLength, size_t(next - pos));
+		pos = next + 1;
+	}
+	auto& options = result.options;
+	options.lineLength = std::min(std::max(maxLineLength * 2, size_t(128)), size_t(UINT16_MAX));
+
+	// Prefer double quotes, but use single quotes if they're used as quotes and double quotes aren't
+	if(sample.indexOf('"') < 0 && isQuoteChar(sample, '\'')) {
+		options.quoteChar = '\'';
+	}
+	result.quoted = (sample.indexOf(options.quoteChar) >= 0);
+
+	options.commentChars = findCommentChars(sample);
+
+	// Choose most consistent separator, with whitespace only used if it's clearly better
+	Rows rows;
+	float bestScore{0};
+	for(auto sep : separators) {
+		if(options.commentChars && sep == *options.commentChars) {
+			continue;
+		}
+		auto opt = options;
+		opt.fieldSeparator = sep;
+		parseSample(sample, opt, rows);
+		auto score = scoreRows(rows);
+		if(sep == '\0') {
+			score -= 0.1;
+		}
+		if(score > bestScore) {
+			bestScore = score;
+			result.options.fieldSeparator = sep;
+		}
+	}
+
+	parseSample(sample, options, rows);
+	if(rows.empty()) {
+		return false;
+	}
+	result.recordCount = rows.size();
+
+	// Infer column types from all rows except the first
+	unsigned columnCount{0};
+	for(auto& row : rows) {
+		columnCount = std::max(columnCount, row.count());
+	}
+	auto& types = result.columnTypes;
+	types.assign(columnCount, ValueType::empty);
+	for(unsigned i = 1; i < rows.size(); ++i) {
+		unsigned col{0};
+		for(auto value : rows[i]) {
+			types[col] = combine(types[col], getValueType(value));
+			++col;
+		}
+	}
+
+	result.hasHeadings = detectHeadings(rows, types);
+	if(!result.hasHeadings) {
+		unsigned col{0};
+		for(auto value : rows[0]) {
+			types[col] = combine(types[col], getValueType(value));
+			++col;
+		}
+	}
+
+	return true;
+}
+
+std::unique_ptr<Reader> Sniffer::createReader(IDataSourceStream* source, Result& result, size_t sampleSize)
+{
+	if(source == nullptr) {
+		return nullptr;
+	}
+	if(!sniff(*source, result, sampleSize)) {
+		delete source;
+		return nullptr;
+	}
+
+	CStringArray headings;
+	if(!result.hasHeadings) {
+		for(unsigned i = 1; i <= result.columnTypes.size(); ++i) {
+			String s(i);
+			headings.add(s.c_str(), s.length());
+		}
+	}
+	return std::make_unique<Reader>(source, result.options, headings);
+}
+
+} // namespace CSV
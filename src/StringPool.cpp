@@ -0,0 +1,138 @@
+/****
+ * StringPool.cpp
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include "include/CSV/StringPool.h"
+#include "include/CSV/Hash.h"
+
+namespace CSV
+{
+StringPool::Id StringPool::add(const char* value, size_t length)
+{
+	if(value == nullptr || length > UINT16_MAX) {
+		return none;
+	}
+
+	auto hash = fnv1a(value, length);
+	auto id = lookup(value, length, hash);
+	if(id != none) {
+		return id;
+	}
+
+	if(entries.size() >= index.maxEntries) {
+		return none;
+	}
+
+	auto copy = static_cast<char*>(arena.allocate(length + 1, 1));
+	if(copy == nullptr) {
+		return none;
+	}
+	memcpy(copy, value, length);
+	copy[length] = '\0';
+
+	if(!append(entries, Entry{copy, uint16_t(length), hash})) {
+		return none;
+	}
+	if(!index.add(hash, entries.size() - 1, [this](unsigned i) { return entries[i].hash; })) {
+		entries.pop_back();
+		return none;
+	}
+	return entries.size();
+}
+
+StringPool::Id StringPool::find(const char* value) const
+{
+	if(value == nullptr) {
+		return none;
+	}
+	auto length = strlen(value);
+	return lookup(value, length, fnv1a(value, length));
+}
+
+StringPool::Id StringPool::lookup(const char* value, size_t length, uint32_t hash) const
+{
+	auto i = index.find(hash, [&](unsigned i) {
+		auto& entry = entries[i];
+		return entry.hash == hash && entry.length == length && memcmp(entry.value, value, length) == 0;
+	});
+	return i + 1;
+}
+
+void StringPool::clear()
+{
+	entries.clear();
+	index.clear();
+	arena.clear();
+}
+
+bool InternTable::add(const CStringArray& row)
+{
+	for(unsigned col = 0; col < columnCount; ++col) {
+		auto value = row[col];
+		auto id = pool.add(value);
+		if(id == StringPool::none && value != nullptr) {
+			// Discard partial row
+			ids.resize(count() * columnCount);
+			return false;
+		}
+		ids.push_back(id);
+	}
+	return true;
+}
+
+size_t InternTable::load(Reader& reader)
+{
+	size_t recordCount{0};
+	while(reader.next()) {
+		if(!add(reader.getRow())) {
+			break;
+		}
+		++recordCount;
+	}
+	return recordCount;
+}
+
+CStringArray InternTable::getRow(unsigned row) const
+{
+	if(row >= count()) {
+		return nullptr;
+	}
+	String values;
+	for(unsigned col = 0; col < columnCount; ++col) {
+		auto id = getId(row, col);
+		values.concat(pool[id] ?: "", pool.getLength(id));
+		values += '\0';
+	}
+	return CStringArray(std::move(values));
+}
+
+int InternTable::find(unsigned column, const char* value, unsigned startRow) const
+{
+	auto id = pool.find(value);
+	if(id == StringPool::none || column >= columnCount) {
+		return -1;
+	}
+	for(unsigned row = startRow; row < count(); ++row) {
+		if(ids[row * columnCount + column] == id) {
+			return row;
+		}
+	}
+	return -1;
+}
+
+} // namespace CSV
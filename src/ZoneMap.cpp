@@ -0,0 +1,312 @@
+/****
+ * ZoneMap.cpp
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include "include/CSV/ZoneMap.h"
+#include "include/CSV/Number.h"
+#include "include/CSV/Memory.h"
+#include <algorithm>
+
+namespace
+{
+constexpr uint32_t zoneMapMagic{0x5A565343}; // "CSVZ"
+
+struct ZoneMapHeader {
+	uint32_t magic;
+	uint16_t columnCount;
+	uint16_t blockSize;
+	uint32_t blockCount;
+};
+
+// Stored size of a summary with empty text: range, numeric flag and two text lengths
+constexpr size_t minSummarySize{2 * sizeof(double) + 1 + 2 * sizeof(uint16_t)};
+
+/*
+ * Range of values to match, numeric if given limits are numbers
+ */
+class Query
+{
+public:
+	Query(const char* min, const char* max) : min(min), max(max)
+	{
+		numeric = (min || max) && (!min || CSV::parseNumber(min, minValue)) &&
+				  (!max || CSV::parseNumber(max, maxValue));
+	}
+
+	bool match(const char* value) const
+	{
+		if(value == nullptr || *value == '\0') {
+			return false;
+		}
+		if(numeric) {
+			double n;
+			if(!CSV::parseNumber(value, n)) {
+				return false;
+			}
+			return (!min || n >= minValue) && (!max || n <= maxValue);
+		}
+		return (!min || strcmp(value, min) >= 0) && (!max || strcmp(value, max) <= 0);
+	}
+
+	bool mayContain(const CSV::ZoneMap::Summary& summary) const
+	{
+		if(!summary.minText) {
+			// No values
+			return false;
+		}
+		if(numeric) {
+			if(!summary.numeric) {
+				return true;
+			}
+			return (!min || summary.max >= minValue) && (!max || summary.min <= maxValue);
+		}
+		return (!min || strcmp(summary.maxText.c_str(), min) >= 0) &&
+			   (!max || strcmp(summary.minText.c_str(), max) <= 0);
+	}
+
+private:
+	const char* min;
+	const char* max;
+	double minValue{0};
+	double maxValue{0};
+	bool numeric;
+};
+
+bool writeText(Print& out, const String& text)
+{
+	uint16_t len = text.length();
+	return out.write(reinterpret_cast<const uint8_t*>(&len), sizeof(len)) == sizeof(len) &&
+		   out.write(reinterpret_cast<const uint8_t*>(text.c_str()), len) == len;
+}
+
+bool readText(Stream& in, String& text)
+{
+	uint16_t len;
+	if(in.readBytes(reinterpret_cast<char*>(&len), sizeof(len)) != sizeof(len)) {
+		return false;
+	}
+	if(len == 0) {
+		text = nullptr;
+		return true;
+	}
+	if(!text.setLength(len)) {
+		return false;
+	}
+	return in.readBytes(text.begin(), len) == len;
+}
+
+} // namespace
+
+namespace CSV
+{
+void ZoneMap::begin(const std::vector<unsigned>& columns, unsigned blockSize)
+{
+	clear();
+	this->columns = columns;
+	this->blockSize = std::max(blockSize, 1U);
+}
+
+void ZoneMap::add(const Cursor& cursor, const CStringArray& row)
+{
+	if(current.count == 0) {
+		current.start = cursor.start;
+		summaries.resize(summaries.size() + columns.size(), Summary{0, 0, nullptr, nullptr, true});
+	}
+	current.end = cursor.end;
+	++current.count;
+
+	auto summary = &summaries[blocks.size() * columns.size()];
+	for(auto column : columns) {
+		auto& s = *summary++;
+		auto value = row[column];
+		if(value == nullptr || *value == '\0') {
+			continue;
+		}
+		bool first = !s.minText;
+		if(first || strcmp(value, s.minText.c_str()) < 0) {
+			s.minText = value;
+		}
+		if(first || strcmp(value, s.maxText.c_str()) > 0) {
+			s.maxText = value;
+		}
+		if(!s.numeric) {
+			continue;
+		}
+		double n;
+		if(!parseNumber(value, n)) {
+			s.numeric = false;
+		} else if(first) {
+			s.min = s.max = n;
+		} else {
+			s.min = std::min(s.min, n);
+			s.max = std::max(s.max, n);
+		}
+	}
+
+	if(current.count == blockSize) {
+		blocks.push_back(current);
+		current = {};
+	}
+}
+
+void ZoneMap::end()
+{
+	if(current.count != 0) {
+		blocks.push_back(current);
+		current = {};
+	}
+}
+
+void ZoneMap::build(Reader& reader, const std::vector<unsigned>& columns, unsigned blockSize)
+{
+	begin(columns, blockSize);
+	reader.reset();
+	while(reader.next()) {
+		add(reader.getCursor(), reader.getRow());
+	}
+	end();
+	reader.reset();
+}
+
+unsigned ZoneMap::columnIndex(unsigned column) const
+{
+	return std::find(columns.begin(), columns.end(), column) - columns.begin();
+}
+
+bool ZoneMap::mayContain(unsigned block, unsigned column, const char* min, const char* max) const
+{
+	auto index = columnIndex(column);
+	if(block >= blocks.size() || index >= columns.size()) {
+		return true;
+	}
+	return Query(min, max).mayContain(summaries[block * columns.size() + index]);
+}
+
+unsigned ZoneMap::scan(Reader& reader, unsigned column, const char* min, const char* max, Callback callback) const
+{
+	Query query(min, max);
+	auto index = columnIndex(column);
+	unsigned matchCount{0};
+	for(unsigned i = 0; i < blocks.size(); ++i) {
+		if(index < columns.size() && !query.mayContain(summaries[i * columns.size() + index])) {
+			continue;
+		}
+		auto& block = blocks[i];
+		if(!reader.seek(block.start, false)) {
+			break;
+		}
+		for(unsigned n = 0;;) {
+			if(query.match(reader.getValue(column))) {
+				++matchCount;
+				if(callback && !callback(reader)) {
+					return matchCount;
+				}
+			}
+			if(++n == block.count || !reader.next()) {
+				break;
+			}
+		}
+	}
+	return matchCount;
+}
+
+bool ZoneMap::save(Print& out) const
+{
+	ZoneMapHeader hdr{zoneMapMagic, uint16_t(columns.size()), uint16_t(blockSize), uint32_t(blocks.size())};
+	if(out.write(reinterpret_cast<const uint8_t*>(&hdr), sizeof(hdr)) != sizeof(hdr)) {
+		return false;
+	}
+	for(auto column : columns) {
+		uint16_t col = column;
+		if(out.write(reinterpret_cast<const uint8_t*>(&col), sizeof(col)) != sizeof(col)) {
+			return false;
+		}
+	}
+	size_t size = blocks.size() * sizeof(Block);
+	if(out.write(reinterpret_cast<const uint8_t*>(blocks.data()), size) != size) {
+		return false;
+	}
+	for(auto& s : summaries) {
+		double range[]{s.min, s.max};
+		uint8_t numeric = s.numeric;
+		if(out.write(reinterpret_cast<const uint8_t*>(range), sizeof(range)) != sizeof(range) ||
+		   out.write(&numeric, 1) != 1 || !writeText(out, s.minText) || !writeText(out, s.maxText)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool ZoneMap::load(Stream& in)
+{
+	clear();
+	columns.clear();
+
+	ZoneMapHeader hdr;
+	if(in.readBytes(reinterpret_cast<char*>(&hdr), sizeof(hdr)) != sizeof(hdr) || hdr.magic != zoneMapMagic) {
+		return false;
+	}
+
+	// Check counts against data available before allocating any memory
+	uint64_t summaryCount = uint64_t(hdr.blockCount) * hdr.columnCount;
+	uint64_t minSize = hdr.columnCount * sizeof(uint16_t) + uint64_t(hdr.blockCount) * sizeof(Block) +
+					   summaryCount * minSummarySize;
+	int available = in.available();
+	if(minSize > SIZE_MAX || (available >= 0 && minSize > uint64_t(available))) {
+		return false;
+	}
+	if(!reserve(columns, hdr.columnCount) || !reserve(blocks, hdr.blockCount) ||
+	   !reserve(summaries, summaryCount)) {
+		clear();
+		columns.clear();
+		return false;
+	}
+
+	for(unsigned i = 0; i < hdr.columnCount; ++i) {
+		uint16_t col;
+		if(in.readBytes(reinterpret_cast<char*>(&col), sizeof(col)) != sizeof(col)) {
+			columns.clear();
+			return false;
+		}
+		columns.push_back(col);
+	}
+	blocks.resize(hdr.blockCount);
+	size_t size = hdr.blockCount * sizeof(Block);
+	bool ok = in.readBytes(reinterpret_cast<char*>(blocks.data()), size) == size;
+	summaries.resize(summaryCount);
+	for(unsigned i = 0; ok && i < summaries.size(); ++i) {
+		auto& s = summaries[i];
+		double range[2]{};
+		uint8_t numeric{0};
+		ok = in.readBytes(reinterpret_cast<char*>(range), sizeof(range)) == sizeof(range) &&
+			 in.readBytes(reinterpret_cast<char*>(&numeric), 1) == 1 && readText(in, s.minText) &&
+			 readText(in, s.maxText);
+		s.min = range[0];
+		s.max = range[1];
+		s.numeric = numeric;
+	}
+	if(!ok) {
+		clear();
+		columns.clear();
+		return false;
+	}
+	blockSize = hdr.blockSize;
+	return true;
+}
+
+} // namespace CSV
@@ -0,0 +1,205 @@
+/****
+ * Aggregate.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "Batch.h"
+#include "Arena.h"
+#include "HashIndex.h"
+#include "Number.h"
+
+namespace CSV
+{
+/**
+ * @brief Running statistics for a set of values
+ */
+struct Stats {
+	uint32_t count{0};		///< Number of records
+	uint32_t valueCount{0}; ///< Number of records with a numeric value
+	double sum{0};
+	double min{0};
+	double max{0};
+
+	/**
+	 * @brief Account for a record
+	 * @param value Field value, or nullptr to only count the record
+	 */
+	void add(const char* value)
+	{
+		++count;
+		double n;
+		if(parseNumber(value, n)) {
+			addValue(n);
+		}
+	}
+
+	void addValue(double value)
+	{
+		if(valueCount == 0) {
+			min = max = value;
+		} else {
+			min = std::min(min, value);
+			max = std::max(max, value);
+		}
+		++valueCount;
+		sum += value;
+	}
+
+	void merge(const Stats& other)
+	{
+		count += other.count;
+		if(other.valueCount == 0) {
+			return;
+		}
+		if(valueCount == 0) {
+			min = other.min;
+			max = other.max;
+		} else {
+			min = std::min(min, other.min);
+			max = std::max(max, other.max);
+		}
+		valueCount += other.valueCount;
+		sum += other.sum;
+	}
+
+	double mean() const
+	{
+		return valueCount ? sum / valueCount : 0;
+	}
+};
+
+/**
+ * @brief Streaming group-by aggregation over one key column
+ *
+ * Groups are held in a hash table keyed on the field content.
+ * Key strings are copied once per distinct group into an Arena, so adding
+ * records for existing groups does not allocate.
+ *
+ * For parallel operation (see Pipeline) use one instance per worker then `merge()` the results.
+ */
+class GroupBy
+{
+public:
+	struct Group {
+		const char* key; ///< NUL-terminated key value
+		uint16_t keyLength;
+		uint32_t hash;
+		Stats stats;
+	};
+
+	/**
+	 * @brief Ordering used by `top()`
+	 */
+	enum class Order {
+		count,
+		sum,
+		min,
+		max,
+	};
+
+	/**
+	 * @brief Construct a group-by aggregator
+	 * @param keyColumn Index of column to group by
+	 * @param valueColumn Index of column with numeric values, -1 to count records only
+	 */
+	GroupBy(unsigned keyColumn, int valueColumn = -1) : keyColumn(keyColumn), valueColumn(valueColumn)
+	{
+	}
+
+	/**
+	 * @brief Account for a single record
+	 * @retval bool false if out of memory or key is too long, see `hasError()`
+	 */
+	bool add(const CStringArray& row);
+
+	/**
+	 * @brief Account for all records in a batch
+	 * @retval bool false if out of memory
+	 */
+	bool add(const Batch& batch);
+
+	/**
+	 * @brief Account for all remaining records from a reader
+	 * @retval size_t Number of records accounted for
+	 * @note Stops at the first record which cannot be added, check `hasError()` afterwards
+	 */
+	size_t run(Reader& reader);
+
+	/**
+	 * @brief Combine results from another instance into this one
+	 * @retval bool false if out of memory
+	 */
+	bool merge(const GroupBy& other);
+
+	/**
+	 * @brief Get number of groups
+	 */
+	unsigned count() const
+	{
+		return groups.size();
+	}
+
+	/**
+	 * @brief Get group by index, in order of first appearance
+	 */
+	const Group& operator[](unsigned index) const
+	{
+		return groups[index];
+	}
+
+	/**
+	 * @brief Find group for a given key
+	 * @retval const Group* nullptr if not found
+	 */
+	const Group* find(const char* key) const;
+
+	/**
+	 * @brief Get groups with the highest values
+	 * @param k Maximum number of groups to return
+	 * @param order Which statistic to rank by
+	 * @retval std::vector<const Group*> Groups in descending order
+	 */
+	std::vector<const Group*> top(unsigned k, Order order = Order::count) const;
+
+	/**
+	 * @brief Determine if any record or merge has failed since construction or `clear()`
+	 * @note Results are then incomplete
+	 */
+	bool hasError() const
+	{
+		return error;
+	}
+
+	/**
+	 * @brief Discard all groups and reset error state
+	 */
+	void clear();
+
+private:
+	Group* lookup(const char* key, size_t keyLength, uint32_t hash, bool create);
+
+	unsigned keyColumn;
+	int valueColumn;
+	Arena arena;
+	std::vector<Group> groups;
+	HashIndex<> index;
+	bool error{false};
+};
+
+} // namespace CSV
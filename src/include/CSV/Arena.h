@@ -0,0 +1,210 @@
+/****
+ * Arena.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include <Data/CStringArray.h>
+
+namespace CSV
+{
+/**
+ * @brief Read-only view of a row whose content is held in an Arena
+ *
+ * Content is the same as CStringArray: a sequence of NUL-terminated values.
+ * The view remains valid until the arena is cleared.
+ */
+class ArenaRow
+{
+public:
+	ArenaRow()
+	{
+	}
+
+	ArenaRow(const char* data, uint16_t length, uint16_t valueCount)
+		: data(data), dataLength(length), valueCount(valueCount)
+	{
+	}
+
+	explicit operator bool() const
+	{
+		return data != nullptr;
+	}
+
+	/**
+	 * @brief Get number of values in row
+	 */
+	unsigned count() const
+	{
+		return valueCount;
+	}
+
+	/**
+	 * @brief Get number of characters in row data, including NUL separators
+	 */
+	size_t length() const
+	{
+		return dataLength;
+	}
+
+	const char* c_str() const
+	{
+		return data;
+	}
+
+	/**
+	 * @brief Get a value from the row
+	 * @param index Column index, starts at 0
+	 * @retval const char* nullptr if index is not valid
+	 */
+	const char* operator[](unsigned index) const;
+
+	/**
+	 * @brief Get a copy of the row
+	 */
+	CStringArray toArray() const
+	{
+		return data ? CStringArray(data, dataLength) : CStringArray();
+	}
+
+	String join(const String& separator = ",") const
+	{
+		return toArray().join(separator);
+	}
+
+private:
+	const char* data{nullptr};
+	uint16_t dataLength{0};
+	uint16_t valueCount{0};
+};
+
+/**
+ * @brief Bump allocator for retaining many rows from a parse
+ *
+ * Storage is obtained in blocks which are released together by `clear()`,
+ * so retaining rows costs one heap allocation per block instead of one per row.
+ * An initial buffer may be provided, such as a static array, in which case
+ * the heap is only used once that is full.
+ */
+class Arena
+{
+public:
+	/**
+	 * @brief Construct an arena using heap storage
+	 * @param blockSize Size of each heap block
+	 */
+	Arena(size_t blockSize = 1024) : blockSize(blockSize)
+	{
+	}
+
+	/**
+	 * @brief Construct an arena using the given buffer first
+	 * @param buffer Storage to use before allocating from heap, must outlive the arena
+	 * @param size Size of buffer in bytes
+	 * @param blockSize Size of each heap block, 0 to disable heap allocation
+	 */
+	Arena(void* buffer, size_t size, size_t blockSize = 0);
+
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	~Arena()
+	{
+		clear();
+	}
+
+	/**
+	 * @brief Allocate memory from the arena
+	 * @param size Number of bytes required
+	 * @param align Required alignment, must be a power of 2
+	 * @retval void* nullptr if out of memory
+	 */
+	void* allocate(size_t size, size_t align = sizeof(void*));
+
+	/**
+	 * @brief Store a copy of some data
+	 * @retval const char* nullptr if out of memory
+	 */
+	const char* store(const char* data, size_t length)
+	{
+		auto ptr = static_cast<char*>(allocate(length, 1));
+		if(ptr != nullptr) {
+			memcpy(ptr, data, length);
+		}
+		return ptr;
+	}
+
+	/**
+	 * @brief Store a copy of a row
+	 * @retval ArenaRow Invalid if out of memory
+	 */
+	ArenaRow add(const CStringArray& row)
+	{
+		auto data = store(row.c_str(), row.length());
+		return data ? ArenaRow(data, row.length(), row.count()) : ArenaRow();
+	}
+
+	/**
+	 * @brief Discard content but retain heap blocks for re-use
+	 */
+	void reset();
+
+	/**
+	 * @brief Discard content and release all heap blocks
+	 */
+	void clear();
+
+	/**
+	 * @brief Get number of bytes allocated from the arena, including alignment padding
+	 */
+	size_t getUsed() const
+	{
+		return used;
+	}
+
+	/**
+	 * @brief Get total size of arena storage
+	 */
+	size_t getCapacity() const
+	{
+		return capacity;
+	}
+
+private:
+	struct Block {
+		Block* next;
+		size_t size;
+		size_t used;
+		bool heap;
+
+		char* data()
+		{
+			return reinterpret_cast<char*>(this + 1);
+		}
+	};
+
+	Block* addBlock(size_t minSize);
+
+	Block* head{nullptr};
+	Block* current{nullptr};
+	size_t blockSize;
+	size_t used{0};
+	size_t capacity{0};
+};
+
+} // namespace CSV
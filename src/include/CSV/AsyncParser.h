@@ -0,0 +1,210 @@
+/****
+ * AsyncParser.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#if defined(ARCH_HOST) && defined(__cpp_impl_coroutine)
+
+#include "Parser.h"
+#include <coroutine>
+#include <utility>
+
+namespace CSV
+{
+/**
+ * @brief Coroutine type for record consumers
+ *
+ * The coroutine starts immediately and runs until it first needs data.
+ * It is then resumed by AsyncParser as data is written.
+ *
+ * The coroutine is destroyed with this object, which must not happen whilst it is
+ * waiting on a parser which may still be written to.
+ */
+class AsyncTask
+{
+public:
+	struct promise_type {
+		AsyncTask get_return_object()
+		{
+			return AsyncTask(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+
+		std::suspend_never initial_suspend() noexcept
+		{
+			return {};
+		}
+
+		std::suspend_always final_suspend() noexcept
+		{
+			return {};
+		}
+
+		void return_void()
+		{
+		}
+
+		void unhandled_exception()
+		{
+			std::terminate();
+		}
+	};
+
+	AsyncTask(AsyncTask&& other) : handle(std::exchange(other.handle, nullptr))
+	{
+	}
+
+	AsyncTask(const AsyncTask&) = delete;
+	AsyncTask& operator=(const AsyncTask&) = delete;
+
+	~AsyncTask()
+	{
+		if(handle) {
+			handle.destroy();
+		}
+	}
+
+	/**
+	 * @brief Determine if coroutine has run to completion
+	 */
+	bool done() const
+	{
+		return !handle || handle.done();
+	}
+
+private:
+	explicit AsyncTask(std::coroutine_handle<promise_type> handle) : handle(handle)
+	{
+	}
+
+	std::coroutine_handle<promise_type> handle;
+};
+
+/**
+ * @brief Parser which delivers records to a coroutine
+ *
+ * Source data is passed to `write()` as it arrives, for example from a socket or HTTP callback.
+ * The consumer is written as straight-line code:
+ *
+ * ```
+ * CSV::AsyncTask consume(CSV::AsyncParser& parser)
+ * {
+ *     while(auto row = co_await parser.next()) {
+ *         ...
+ *     }
+ * }
+ * ```
+ *
+ * The consumer is suspended when the parser needs more input, and resumed from within `write()`
+ * so records are parsed directly from the written data. Only data which the consumer has not
+ * requested by the time `write()` returns is copied.
+ *
+ * @note Available in host builds only
+ */
+class AsyncParser : private Parser
+{
+public:
+	/**
+	 * @brief Awaitable returned from `next()`
+	 */
+	class NextRecord
+	{
+	public:
+		NextRecord(AsyncParser& parser) : parser(parser)
+		{
+		}
+
+		bool await_ready()
+		{
+			return parser.fetch();
+		}
+
+		void await_suspend(std::coroutine_handle<> handle)
+		{
+			parser.consumer = handle;
+		}
+
+		const CStringArray* await_resume()
+		{
+			return parser.result;
+		}
+
+	private:
+		AsyncParser& parser;
+	};
+
+	using Parser::Parser;
+
+	/**
+	 * @brief Get the next record
+	 * @retval NextRecord Awaitable yielding `const CStringArray*`, nullptr when there are no more records
+	 *
+	 * Only one coroutine may wait on the parser at a time.
+	 */
+	NextRecord next()
+	{
+		return NextRecord(*this);
+	}
+
+	/**
+	 * @brief Parse source data
+	 * @param data
+	 * @param length
+	 *
+	 * Any waiting consumer is resumed until all data has been parsed.
+	 */
+	void write(const char* data, size_t length);
+
+	/**
+	 * @brief Indicate end of source data
+	 *
+	 * The consumer is resumed with any remaining records, after which `next()` returns nullptr.
+	 */
+	void end();
+
+	/**
+	 * @brief Determine if a consumer is waiting for data
+	 */
+	bool isWaiting() const
+	{
+		return bool(consumer);
+	}
+
+	using Parser::getCursor;
+	using Parser::getOptions;
+	using Parser::getRow;
+	using Parser::tell;
+
+private:
+	bool fetch();
+	void resume();
+
+	std::coroutine_handle<> consumer;
+	const CStringArray* result{nullptr};
+	const char* data{nullptr};
+	size_t length{0};
+	size_t offset{0};
+	String pending; ///< Data written whilst consumer was not waiting
+	size_t pendingOffset{0};
+	bool finished{false};
+	bool done{false};
+};
+
+} // namespace CSV
+
+#endif // ARCH_HOST && __cpp_impl_coroutine
@@ -0,0 +1,95 @@
+/****
+ * Batch.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "Reader.h"
+#include <vector>
+
+namespace CSV
+{
+/**
+ * @brief A block of parsed rows which can be recycled
+ *
+ * Clearing a batch keeps the row buffers, so once they have grown to
+ * accommodate typical records refilling a batch does not allocate.
+ */
+class Batch
+{
+public:
+	/**
+	 * @brief Read up to `maxRows` records from a reader, replacing current content
+	 * @retval unsigned Number of rows read
+	 */
+	unsigned fill(Reader& reader, unsigned maxRows)
+	{
+		clear();
+		while(used < maxRows && reader.next()) {
+			add(reader.getRow(), reader.getCursor());
+		}
+		return used;
+	}
+
+	/**
+	 * @brief Append a row
+	 */
+	void add(const CStringArray& row, const Cursor& cursor)
+	{
+		if(used == rows.size()) {
+			rows.emplace_back(row);
+			cursors.push_back(cursor);
+		} else {
+			rows[used] = row;
+			cursors[used] = cursor;
+		}
+		++used;
+	}
+
+	/**
+	 * @brief Discard rows but retain buffers for re-use
+	 */
+	void clear()
+	{
+		used = 0;
+	}
+
+	unsigned count() const
+	{
+		return used;
+	}
+
+	const CStringArray& operator[](unsigned index) const
+	{
+		return rows[index];
+	}
+
+	const Cursor& getCursor(unsigned index) const
+	{
+		return cursors[index];
+	}
+
+	unsigned sequence{0}; ///< Position of this batch in the source, starting at 0
+
+private:
+	std::vector<CStringArray> rows;
+	std::vector<Cursor> cursors;
+	unsigned used{0};
+};
+
+} // namespace CSV
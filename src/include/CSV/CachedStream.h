@@ -0,0 +1,108 @@
+/****
+ * CachedStream.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include <Data/Stream/DataSourceStream.h>
+#include <memory>
+
+namespace CSV
+{
+/**
+ * @brief Stream wrapper which keeps recently read blocks of its source in memory
+ *
+ * Reader::seek() re-reads source data unless the target is already buffered by the parser.
+ * Where access alternates between nearby records (e.g. using `prev()`) wrapping the source
+ * in this class means most seeks need no source I/O.
+ *
+ * The source must support random seeking (seekFrom). Blocks are replaced on a least-recently-used basis.
+ */
+class CachedStream : public IDataSourceStream
+{
+public:
+	/**
+	 * @brief Construct a cached stream
+	 * @param source Stream to read, takes ownership
+	 * @param blockCount Number of blocks to cache
+	 * @param blockSize Size of each block
+	 */
+	CachedStream(IDataSourceStream* source, unsigned blockCount = 4, uint16_t blockSize = 256);
+
+	uint16_t readMemoryBlock(char* data, int bufSize) override;
+
+	int seekFrom(int offset, SeekOrigin origin) override;
+
+	bool isFinished() override
+	{
+		return pos >= size;
+	}
+
+	int available() override
+	{
+		return size - pos;
+	}
+
+	bool isValid() const override
+	{
+		return source && size >= 0;
+	}
+
+	String getName() const override
+	{
+		return source ? source->getName() : nullptr;
+	}
+
+	/**
+	 * @brief Get number of blocks read from source
+	 */
+	unsigned getMissCount() const
+	{
+		return missCount;
+	}
+
+	/**
+	 * @brief Get number of reads satisfied from cache
+	 */
+	unsigned getHitCount() const
+	{
+		return hitCount;
+	}
+
+private:
+	struct Block {
+		int index{-1}; ///< Block number in source, -1 if unused
+		uint16_t length{0};
+		uint32_t lastUse{0};
+		std::unique_ptr<char[]> data;
+	};
+
+	Block* getBlock(int index);
+
+	std::unique_ptr<IDataSourceStream> source;
+	std::unique_ptr<Block[]> blocks;
+	unsigned blockCount;
+	uint16_t blockSize;
+	int size;
+	int pos{0};
+	uint32_t useCount{0};
+	unsigned missCount{0};
+	unsigned hitCount{0};
+};
+
+} // namespace CSV
@@ -0,0 +1,84 @@
+/****
+ * CodeGenerator.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "Reader.h"
+#include "Number.h"
+#include <vector>
+
+namespace CSV
+{
+/**
+ * @brief Generate C++ source code containing CSV data as constant tables
+ *
+ * Intended for use at build time (via the `csvgen` host tool) for data which doesn't change,
+ * so applications access records directly with no parsing or startup cost.
+ *
+ * The generated header contains, within the given namespace:
+ *
+ * - `struct Record` with one member per column, named from the headings
+ * - `constexpr Record records[]` containing all records
+ * - `constexpr const char* columnNames[]`
+ * - `find(&Record::member, value)` plus a `findBy<member>(value)` helper for text and integer columns
+ *
+ * Text columns are stored as `const char*`, integers as `int32_t` or `int64_t` depending on range
+ * and numbers as `double`. Column types are inferred from the data unless specified.
+ */
+class CodeGenerator
+{
+public:
+	/**
+	 * @brief Construct a code generator
+	 * @param reader Source of data
+	 * @param types Optional list of column types, use `ValueType::empty` to infer type from data
+	 */
+	CodeGenerator(Reader& reader, const std::vector<ValueType>& types = {});
+
+	/**
+	 * @brief Write generated header
+	 * @param out Where to write output
+	 * @param name Namespace for generated code, may be qualified (e.g. "Data::Zones")
+	 * @retval bool true on success, false if a value doesn't match the column type
+	 * @note On return the reader is reset
+	 */
+	bool generate(Print& out, const char* name);
+
+	/**
+	 * @brief Convert a column heading into a valid C++ identifier
+	 *
+	 * Invalid characters are replaced with `_`, and keywords have `_` appended.
+	 */
+	static String makeIdentifier(const char* name);
+
+private:
+	struct Column {
+		String identifier;
+		ValueType type;
+		bool wide;
+	};
+
+	void scan(const std::vector<ValueType>& types);
+	bool writeValue(Print& out, const Column& column, const char* value);
+
+	Reader& reader;
+	std::vector<Column> columns;
+};
+
+} // namespace CSV
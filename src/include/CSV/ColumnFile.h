@@ -0,0 +1,307 @@
+/****
+ * ColumnFile.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "Reader.h"
+#include "Number.h"
+
+namespace CSV
+{
+/**
+ * @brief Read-only columnar table, converted from CSV data so values can be used without parsing
+ *
+ * The table is generated using `ColumnFile::build()`, typically via the `csvgen` host tool.
+ * Records are stored in chunks, and within each chunk every column is stored separately
+ * with its own type and encoding. A single column can therefore be read without touching
+ * the others, and numeric values are available directly as arrays.
+ *
+ * Layout, all values little-endian:
+ *
+ * - Header
+ * - Column names: NUL-terminated values
+ * - Column chunks: ChunkHeader followed by content, for each column of each chunk
+ * - Footer: column types, first record of each chunk then offsets of column chunks
+ * - Trailer
+ *
+ * Each section starts on an 8-byte boundary.
+ *
+ * Column chunk content depends on the encoding:
+ *
+ * - empty: None, all values are empty
+ * - integer: Validity bitmap if any values are empty, then int64_t[count]
+ * - number: Validity bitmap if any values are empty, then double[count]
+ * - text: Offsets uint32_t[count + 1], then NUL-terminated values
+ * - dictionary8, dictionary16: Codes uint8_t[count] or uint16_t[count],
+ *   then offsets uint32_t[dictCount + 1] and NUL-terminated dictionary values
+ *
+ * Offsets are relative to the first value. The validity bitmap has one bit per record, set if the value
+ * is present, padded to 8 bytes.
+ *
+ * The footer is written last so output can be streamed, with memory use limited to one chunk.
+ */
+class ColumnFile
+{
+public:
+	enum class Encoding : uint8_t {
+		empty,
+		integer,
+		number,
+		text,
+		dictionary8,
+		dictionary16,
+	};
+
+	struct Header {
+		uint32_t magic;
+		uint16_t version;
+		uint16_t columnCount;
+		uint32_t headingsSize; ///< Size of column names, including NULs
+		uint32_t reserved;
+	};
+
+	struct ChunkHeader {
+		Encoding encoding;
+		uint8_t flags;
+		uint16_t reserved;
+		uint32_t count;		///< Number of records
+		uint32_t size;		///< Size of content following header
+		uint32_t dictCount; ///< Number of dictionary values
+	};
+
+	struct Trailer {
+		uint32_t footerOffset;
+		uint32_t chunkCount;
+		uint32_t recordCount;
+		uint32_t magic;
+	};
+
+	static constexpr uint32_t magic{0x43565343}; // "CSVC"
+	static constexpr uint16_t version{1};
+	static constexpr uint8_t flagValidity{0x01}; ///< ChunkHeader flag indicating a validity bitmap is present
+
+	struct Settings {
+		uint32_t chunkRecords{1024}; ///< Maximum number of records per chunk
+		uint32_t chunkSize{16384};	 ///< Start a new chunk when text for current one exceeds this size
+		bool dictionary{true};		 ///< Use dictionary encoding for text columns where it reduces size
+	};
+
+	/**
+	 * @brief View of one column of one chunk
+	 */
+	class Chunk
+	{
+	public:
+		Chunk()
+		{
+		}
+
+		Chunk(const ChunkHeader* header);
+
+		explicit operator bool() const
+		{
+			return header != nullptr;
+		}
+
+		Encoding getEncoding() const
+		{
+			return header ? header->encoding : Encoding::empty;
+		}
+
+		/**
+		 * @brief Get number of records
+		 */
+		unsigned count() const
+		{
+			return header ? header->count : 0;
+		}
+
+		/**
+		 * @brief Determine if a value is empty
+		 * @param index Record index within chunk
+		 */
+		bool isEmpty(unsigned index) const;
+
+		/**
+		 * @brief Get a value as integer
+		 * @retval int64_t 0 if value is empty or column is text
+		 */
+		int64_t getInteger(unsigned index) const;
+
+		/**
+		 * @brief Get a value as number
+		 * @retval double 0 if value is empty or column is text
+		 */
+		double getNumber(unsigned index) const;
+
+		/**
+		 * @brief Get a text value
+		 * @retval const char* nullptr if index is invalid or column is not text
+		 */
+		const char* getText(unsigned index) const;
+
+		/**
+		 * @brief Get values for an integer column
+		 * @retval const int64_t* nullptr if column is not integer
+		 * @note Check `isEmpty()` if there may be empty values, for which the array contains 0
+		 */
+		const int64_t* getIntegers() const
+		{
+			return getEncoding() == Encoding::integer ? reinterpret_cast<const int64_t*>(values) : nullptr;
+		}
+
+		/**
+		 * @brief Get values for a number column
+		 * @retval const double* nullptr if column is not number
+		 * @note Check `isEmpty()` if there may be empty values, for which the array contains 0
+		 */
+		const double* getNumbers() const
+		{
+			return getEncoding() == Encoding::number ? reinterpret_cast<const double*>(values) : nullptr;
+		}
+
+		/**
+		 * @brief Get number of distinct values in a dictionary-encoded column
+		 */
+		unsigned getDictionarySize() const
+		{
+			return isDictionary() ? header->dictCount : 0;
+		}
+
+		/**
+		 * @brief Get dictionary code for a value
+		 * @retval unsigned Index for `getDictionaryValue()`
+		 */
+		unsigned getCode(unsigned index) const;
+
+		/**
+		 * @brief Get a dictionary value
+		 * @retval const char* nullptr if code is invalid
+		 */
+		const char* getDictionaryValue(unsigned code) const
+		{
+			return (code < getDictionarySize()) ? text + offsets[code] : nullptr;
+		}
+
+	private:
+		bool isDictionary() const
+		{
+			auto enc = getEncoding();
+			return enc == Encoding::dictionary8 || enc == Encoding::dictionary16;
+		}
+
+		const ChunkHeader* header{nullptr};
+		const uint8_t* validity{nullptr};
+		const uint8_t* values{nullptr};
+		const uint32_t* offsets{nullptr};
+		const char* text{nullptr};
+	};
+
+	/**
+	 * @brief Construct a table from data in memory, such as a memory-mapped file (see MappedFile)
+	 * @param data Content generated by `build()`, 8-byte aligned, must outlive this object
+	 * @param length Size of data
+	 */
+	ColumnFile(const void* data, size_t length);
+
+	/**
+	 * @brief Write table content from a reader
+	 * @param reader Source data, all remaining records are written
+	 * @param out Where to write the table
+	 * @retval bool true on success
+	 */
+	static bool build(Reader& reader, Print& out)
+	{
+		return build(reader, out, Settings{});
+	}
+
+	static bool build(Reader& reader, Print& out, const Settings& settings);
+
+	/**
+	 * @brief Determine if table data is valid
+	 */
+	explicit operator bool() const
+	{
+		return trailer != nullptr;
+	}
+
+	/**
+	 * @brief Get number of records
+	 */
+	unsigned count() const
+	{
+		return trailer ? trailer->recordCount : 0;
+	}
+
+	unsigned getColumnCount() const
+	{
+		return trailer ? header->columnCount : 0;
+	}
+
+	unsigned getChunkCount() const
+	{
+		return trailer ? trailer->chunkCount : 0;
+	}
+
+	/**
+	 * @brief Get index of first record in a chunk
+	 */
+	unsigned getChunkStart(unsigned chunk) const
+	{
+		return (chunk < getChunkCount()) ? chunkStarts[chunk] : count();
+	}
+
+	/**
+	 * @brief Get column name
+	 * @retval const char* nullptr if column is invalid
+	 */
+	const char* getHeading(unsigned column) const;
+
+	/**
+	 * @brief Get index of column given its name
+	 * @retval int -1 if name is not found
+	 */
+	int getColumn(const char* name) const;
+
+	/**
+	 * @brief Get type able to represent all values in a column
+	 */
+	ValueType getType(unsigned column) const
+	{
+		return (column < getColumnCount()) ? ValueType(types[column]) : ValueType::empty;
+	}
+
+	/**
+	 * @brief Get view of one column of a chunk
+	 * @retval Chunk Invalid if chunk or column are out of range
+	 */
+	Chunk getChunk(unsigned chunk, unsigned column) const;
+
+private:
+	const uint8_t* data;
+	const Header* header{nullptr};
+	const Trailer* trailer{nullptr};
+	const uint8_t* types{nullptr};
+	const uint32_t* chunkStarts{nullptr};
+	const uint32_t* chunkOffsets{nullptr};
+};
+
+} // namespace CSV
+
+String toString(CSV::ColumnFile::Encoding encoding);
@@ -0,0 +1,119 @@
+/****
+ * Diff.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "Reader.h"
+#include "HashIndex.h"
+
+namespace CSV
+{
+/**
+ * @brief Find differences between two versions of a CSV file
+ *
+ * Each file is read once. Records of the old file are stored in a hash table as a key hash,
+ * a content hash and a location, then records of the new file are looked up as they are read.
+ *
+ * If a key column is given, records with the same key but different content are reported as changed.
+ * Otherwise records are matched on their entire content, so a modified record is reported as
+ * removed plus inserted.
+ *
+ * Both readers must be created with Options::hashFields set.
+ *
+ * @note Comparison uses only 32-bit hashes, so there is a very small chance that a
+ * change is not detected.
+ */
+class Diff
+{
+public:
+	enum class Kind {
+		inserted, ///< Record present only in new data
+		removed,  ///< Record present only in old data
+		changed,  ///< Record with same key has different content
+	};
+
+	struct Change {
+		Kind kind;
+		int oldRecord; ///< Cursor::start of record in old data, BOF if inserted
+		int newRecord; ///< Cursor::start of record in new data, BOF if removed
+	};
+
+	/**
+	 * @brief Called for each difference
+	 *
+	 * For inserted and changed records the new reader is positioned on the record.
+	 * Removed records are reported in source order after the new data has been read.
+	 */
+	using Callback = Delegate<void(const Change& change)>;
+
+	struct Summary {
+		unsigned unchanged;
+		unsigned inserted;
+		unsigned removed;
+		unsigned changed;
+	};
+
+	/**
+	 * @brief Construct a diff
+	 * @param keyColumn Index of column which identifies records, -1 to match on content only
+	 */
+	Diff(int keyColumn = -1) : keyColumn(keyColumn)
+	{
+	}
+
+	/**
+	 * @brief Compare two data sets
+	 * @param oldReader
+	 * @param newReader
+	 * @param callback Invoked for each difference, may be nullptr
+	 * @retval bool false if hashing is not enabled for both readers, or out of memory
+	 */
+	bool compare(Reader& oldReader, Reader& newReader, Callback callback);
+
+	/**
+	 * @brief Get record counts from last comparison
+	 */
+	const Summary& getSummary() const
+	{
+		return summary;
+	}
+
+private:
+	struct Entry {
+		uint32_t key;  ///< Hash of key field, or record hash if there is no key column
+		uint32_t hash; ///< Record hash
+		int start;	   ///< Location in old data
+		bool matched;
+	};
+
+	uint32_t getKey(const Reader& reader) const
+	{
+		return (keyColumn < 0) ? reader.getHash() : reader.getFieldHash(keyColumn);
+	}
+
+	bool insert(const Entry& entry);
+	Entry* match(uint32_t key, uint32_t hash);
+
+	std::vector<Entry> entries; ///< Old records in source order
+	HashIndex<> index;			///< Looks up entries by key
+	int keyColumn;
+	Summary summary{};
+};
+
+} // namespace CSV
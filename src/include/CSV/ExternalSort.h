@@ -0,0 +1,158 @@
+/****
+ * ExternalSort.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "Parser.h"
+#include <FileSystem.h>
+
+namespace CSV
+{
+/**
+ * @brief Sort a CSV file which may be larger than available memory
+ *
+ * The input is read in chunks limited by the memory budget. For each chunk only the record
+ * locations and key values are held in memory. These are sorted, then the corresponding records
+ * are copied from the input to a temporary run file. Finally all runs are merged into the output.
+ *
+ * Records are copied unchanged, so quoting is preserved, as is the header (all data preceding
+ * the first record). Comment and blank lines within the data are not copied.
+ * Each output record is terminated with a newline, and the sort is stable.
+ *
+ * In host builds runs are sorted and written using multiple threads whilst the input is parsed.
+ *
+ * The number of runs merged at once is limited by the memory budget, as each needs a buffer.
+ * If there are more runs than this then groups of runs are first merged into larger runs.
+ */
+class ExternalSort
+{
+public:
+	struct Settings {
+		/**
+		 * Memory to use for record locations and keys, shared between threads.
+		 * Also limits the number of runs merged at once to (memoryLimit / bufferSize) - 1.
+		 */
+		size_t memoryLimit = 16384;
+		/**
+		 * Number of threads used to write runs (host only), 0 for number of CPUs.
+		 * Reduced if necessary so that each thread gets at least 1KB of the memory budget.
+		 */
+		unsigned threadCount = 0;
+		/**
+		 * Size of buffer for each run file and the output during merge
+		 */
+		uint16_t bufferSize = 512;
+		/**
+		 * Compare keys as numbers. Values which are not numbers are sorted after those which are.
+		 */
+		bool numeric = false;
+		/**
+		 * Prefix for temporary filenames, if not set the output filename is used
+		 */
+		String tempPrefix;
+		/**
+		 * File system for input, output and temporary files, nullptr for default
+		 */
+		IFS::FileSystem* fileSystem = nullptr;
+	};
+
+	ExternalSort(const Parser::Options& options) : options(options)
+	{
+	}
+
+	ExternalSort(const Parser::Options& options, const Settings& settings) : options(options), settings(settings)
+	{
+	}
+
+	/**
+	 * @brief Sort a file
+	 * @param input Name of file to sort, which must contain field headings as first row
+	 * @param output Name of file to write sorted data to
+	 * @param column Index of column to sort by
+	 * @retval bool false on error
+	 */
+	bool sort(const String& input, const String& output, unsigned column);
+
+	/**
+	 * @brief Perform first stage of a sort, writing sorted runs
+	 * @param input Name of file to sort
+	 * @param column Index of column to sort by
+	 * @retval bool false on error
+	 *
+	 * `sort()` is equivalent to calling this followed by `merge()`.
+	 * Temporary files are named using Settings::tempPrefix, or the input filename if not set.
+	 * They remain until `merge()` is called.
+	 */
+	bool createRuns(const String& input, unsigned column);
+
+	/**
+	 * @brief Perform second stage of a sort, merging runs into the output and removing them
+	 * @param output Name of file to write sorted data to
+	 * @retval bool false on error, including if a run is missing or incomplete
+	 */
+	bool merge(const String& output);
+
+	/**
+	 * @brief Get name of a temporary file
+	 * @param run Index of run, from 0 to `getRunCount() - 1`
+	 */
+	String getRunName(unsigned run) const;
+
+	/**
+	 * @brief Get number of runs created by last sort
+	 */
+	unsigned getRunCount() const
+	{
+		return runCount;
+	}
+
+	/**
+	 * @brief Get number of passes required to merge runs in last sort
+	 */
+	unsigned getMergePassCount() const
+	{
+		return mergePassCount;
+	}
+
+	/**
+	 * @brief Get number of records sorted
+	 */
+	unsigned getRecordCount() const
+	{
+		return recordCount;
+	}
+
+private:
+	bool writeRuns(const String& input, unsigned column);
+	bool writeOutput(const String& output);
+	void removeRuns();
+
+	Parser::Options options;
+	Settings settings;
+	IFS::FileSystem* fileSystem{nullptr};
+	String tempPrefix;
+	String inputName; ///< Set when runs are ready to merge
+	int headerLength{-1};
+	unsigned runCount{0};
+	unsigned fileCount{0}; ///< Number of temporary files created, including intermediate merges
+	unsigned mergePassCount{0};
+	unsigned recordCount{0};
+};
+
+} // namespace CSV
@@ -0,0 +1,169 @@
+/****
+ * FlashTable.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "Reader.h"
+#include <FlashString/ObjectBase.hpp>
+
+namespace CSV
+{
+/**
+ * @brief Read-only table stored in flash memory, pre-parsed at build time
+ *
+ * The table is generated from CSV data using `FlashTable::build()`, typically via the `csvgen` host tool,
+ * and imported into the application using `IMPORT_FSTR`.
+ * Fields are read directly from flash when required so there is no parsing at runtime
+ * and RAM usage is limited to the requested values.
+ *
+ * Layout, all values little-endian and 32-bit aligned:
+ *
+ * - Header
+ * - Field offsets: uint32_t[(recordCount + 1) * columnCount + 1], headings first
+ * - Field data: NUL-terminated values, contiguous for each record
+ *
+ * Field offsets are relative to the start of field data. Every record has `columnCount` fields:
+ * missing values are stored as empty strings and additional values are discarded.
+ */
+class FlashTable
+{
+public:
+	struct Header {
+		uint32_t magic;
+		uint16_t columnCount;
+		uint16_t reserved;
+		uint32_t recordCount;
+		uint32_t dataOffset; ///< Offset of field data from start of table
+	};
+
+	static constexpr uint32_t magic{0x54565343}; // "CSVT"
+
+	/**
+	 * @brief Construct a table from imported data
+	 * @param data Content generated by `build()`
+	 */
+	FlashTable(const FSTR::ObjectBase& data);
+
+	/**
+	 * @brief Write table content from a reader
+	 * @param reader Source data, all records are written
+	 * @param out Where to write the table
+	 * @retval bool true on success
+	 * @note On return the reader is reset
+	 */
+	static bool build(Reader& reader, Print& out);
+
+	/**
+	 * @brief Determine if table data is valid
+	 */
+	explicit operator bool() const
+	{
+		return header.magic == magic;
+	}
+
+	/**
+	 * @brief Get number of records (excluding headings)
+	 */
+	unsigned count() const
+	{
+		return header.recordCount;
+	}
+
+	/**
+	 * @brief Get number of columns
+	 */
+	unsigned getColumnCount() const
+	{
+		return header.columnCount;
+	}
+
+	/**
+	 * @brief Get index of column given its name
+	 * @retval int -1 if name is not found
+	 */
+	int getColumn(const char* name) const;
+
+	/**
+	 * @brief Get column name
+	 */
+	String getHeading(unsigned column) const
+	{
+		return readValue(0, column);
+	}
+
+	/**
+	 * @brief Get length of a value
+	 * @param record Record index, from 0
+	 * @param column Column index
+	 * @retval int -1 if record or column are invalid
+	 */
+	int getLength(unsigned record, unsigned column) const;
+
+	/**
+	 * @brief Read value into a buffer
+	 * @param record Record index, from 0
+	 * @param column Column index
+	 * @param buffer Value is NUL-terminated, truncated if necessary
+	 * @param bufSize Size of buffer
+	 * @retval int Length of value, -1 if record or column are invalid
+	 */
+	int read(unsigned record, unsigned column, char* buffer, size_t bufSize) const;
+
+	/**
+	 * @brief Get a value
+	 * @retval String invalid if record or column are invalid
+	 */
+	String getValue(unsigned record, unsigned column) const
+	{
+		return readValue(record + 1, column);
+	}
+
+	/**
+	 * @brief Get copy of an entire record
+	 * @retval CStringArray invalid if record is invalid
+	 */
+	CStringArray getRow(unsigned record) const;
+
+	/**
+	 * @brief Find first record with a matching value
+	 * @param column Column to search
+	 * @param value Value to find
+	 * @param startRecord Index of first record to check
+	 * @retval int Record index, -1 if not found
+	 * @note Values are compared in small blocks without copying them to RAM
+	 */
+	int find(unsigned column, const char* value, unsigned startRecord = 0) const;
+
+private:
+	uint32_t getOffset(unsigned index) const
+	{
+		uint32_t offset{0};
+		data.read(sizeof(Header) + index * sizeof(uint32_t), &offset, sizeof(offset));
+		return offset;
+	}
+
+	bool getField(unsigned row, unsigned column, uint32_t& offset, uint32_t& length) const;
+	String readValue(unsigned row, unsigned column) const;
+	bool compare(uint32_t offset, const char* value, size_t length) const;
+
+	const FSTR::ObjectBase& data;
+	Header header{};
+};
+
+} // namespace CSV
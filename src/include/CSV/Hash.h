@@ -0,0 +1,52 @@
+/****
+ * Hash.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace CSV
+{
+/**
+ * @brief Compute 32-bit FNV-1a hash of some data
+ * @param data
+ * @param length Number of bytes
+ * @param hash Initial value, use to combine hashes
+ */
+inline uint32_t fnv1a(const void* data, size_t length, uint32_t hash = 2166136261U)
+{
+	auto ptr = static_cast<const uint8_t*>(data);
+	for(size_t i = 0; i < length; ++i) {
+		hash = (hash ^ ptr[i]) * 16777619U;
+	}
+	return hash;
+}
+
+/**
+ * @brief Compute 32-bit xxHash (XXH32) of some data
+ * @param data
+ * @param length Number of bytes
+ * @param seed Initial value
+ *
+ * Processes 16 bytes per iteration so is much faster than `fnv1a()` for longer data.
+ */
+uint32_t xxh32(const void* data, size_t length, uint32_t seed = 0);
+
+} // namespace CSV
@@ -0,0 +1,158 @@
+/****
+ * HashIndex.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "Memory.h"
+#include <limits>
+
+namespace CSV
+{
+/**
+ * @brief Open-addressing hash table of indices into a separate list of entries
+ * @tparam Index Type used to store entry indices, limits number of entries
+ *
+ * The owner keeps the entries, typically in a vector, and supplies the hash of each.
+ * Slots hold index + 1, with 0 for empty, and collisions are resolved by linear probing.
+ * The table is doubled in size as required to keep the load factor below 3/4.
+ *
+ * Entries are numbered consecutively from 0 in the order added. Entries with equal hash values
+ * are visited by `probe()` in that order.
+ */
+template <typename Index = uint32_t> class HashIndex
+{
+public:
+	static constexpr size_t maxEntries{std::numeric_limits<Index>::max()};
+
+	/**
+	 * @brief Visit entries which may match a hash value
+	 * @param hash
+	 * @param callback Invoked as `bool callback(unsigned index)`, return false to stop
+	 *
+	 * Entries with different hash values may be visited, so the callback must check for a match.
+	 */
+	template <typename Callback> void probe(uint32_t hash, Callback callback) const
+	{
+		if(slots.empty()) {
+			return;
+		}
+		auto mask = slots.size() - 1;
+		for(auto i = hash & mask; slots[i] != 0; i = (i + 1) & mask) {
+			if(!callback(unsigned(slots[i] - 1))) {
+				return;
+			}
+		}
+	}
+
+	/**
+	 * @brief Find an entry
+	 * @param hash
+	 * @param match Invoked as `bool match(unsigned index)`, return true if entry matches
+	 * @retval int Index of matching entry, -1 if not found
+	 */
+	template <typename Match> int find(uint32_t hash, Match match) const
+	{
+		int result{-1};
+		probe(hash, [&](unsigned index) {
+			if(!match(index)) {
+				return true;
+			}
+			result = index;
+			return false;
+		});
+		return result;
+	}
+
+	/**
+	 * @brief Add an entry
+	 * @param hash Hash value for the new entry
+	 * @param index Position of new entry, must be the number of entries already added
+	 * @param getHash Invoked as `uint32_t getHash(unsigned index)` to re-insert entries when the table grows
+	 * @retval bool false if table is full, index is out of sequence or out of memory
+	 */
+	template <typename GetHash> bool add(uint32_t hash, unsigned index, GetHash getHash)
+	{
+		if(index != used || index >= maxEntries) {
+			return false;
+		}
+		if((used + 1) * 4 > slots.size() * 3) {
+			if(!grow(getHash)) {
+				return false;
+			}
+		}
+		insert(hash, index);
+		++used;
+		return true;
+	}
+
+	/**
+	 * @brief Get number of entries
+	 */
+	size_t count() const
+	{
+		return used;
+	}
+
+	/**
+	 * @brief Get memory used by table
+	 */
+	size_t getMemoryUsed() const
+	{
+		return slots.capacity() * sizeof(Index);
+	}
+
+	void clear()
+	{
+		slots.clear();
+		slots.shrink_to_fit();
+		used = 0;
+	}
+
+private:
+	void insert(uint32_t hash, unsigned index)
+	{
+		auto mask = slots.size() - 1;
+		auto i = hash & mask;
+		while(slots[i] != 0) {
+			i = (i + 1) & mask;
+		}
+		slots[i] = index + 1;
+	}
+
+	template <typename GetHash> bool grow(GetHash getHash)
+	{
+		size_t newSize = slots.empty() ? 16 : slots.size() * 2;
+		std::vector<Index> newSlots;
+		if(!reserve(newSlots, newSize)) {
+			return false;
+		}
+		newSlots.resize(newSize);
+		std::swap(slots, newSlots);
+		// Re-insert in order added so probe order is retained
+		for(unsigned index = 0; index < used; ++index) {
+			insert(getHash(index), index);
+		}
+		return true;
+	}
+
+	std::vector<Index> slots;
+	size_t used{0};
+};
+
+} // namespace CSV
@@ -0,0 +1,143 @@
+/****
+ * HashJoin.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "Reader.h"
+#include "Arena.h"
+#include "HashIndex.h"
+
+namespace CSV
+{
+/**
+ * @brief Join records of two CSV tables on equal key values
+ *
+ * The smaller (build) table is read once into a compact hash table holding only the key,
+ * the record location and any requested fields. The larger (probe) table is then streamed
+ * through it, so memory use depends only on the build side.
+ *
+ * Keys are compared as text. Empty keys are ignored.
+ */
+class HashJoin
+{
+public:
+	/**
+	 * @brief Build record matching a probe record
+	 */
+	struct Match {
+		int record;		 ///< Cursor::start of record in build data, BOF if none (outer join)
+		ArenaRow fields; ///< Fields stored by `build()` in the order requested, invalid if none
+	};
+
+	enum class Error {
+		none,
+		noMemory,	   ///< Memory limit exceeded or allocation failed
+		recordTooLong, ///< Key plus stored fields for a record exceed 65535 characters
+	};
+
+	/**
+	 * @brief Called for each joined record
+	 * @param probe Reader positioned on the probe record
+	 * @param match
+	 * @retval bool Return false to stop
+	 */
+	using Callback = Delegate<bool(Reader& probe, const Match& match)>;
+
+	/**
+	 * @brief Construct a hash join
+	 * @param maxBytes Limit on memory used by build table, 0 for no limit
+	 */
+	HashJoin(size_t maxBytes = 0) : maxBytes(maxBytes)
+	{
+	}
+
+	/**
+	 * @brief Read build table
+	 * @param reader
+	 * @param keyColumn
+	 * @param columns Fields to store with each record, available via Match::fields
+	 * @retval bool false on error, see `getError()`
+	 *
+	 * If no fields are stored then use Match::record to seek the build reader for a joined record.
+	 */
+	bool build(Reader& reader, unsigned keyColumn, const std::vector<unsigned>& columns = {});
+
+	/**
+	 * @brief Join remaining records from a reader with the build table
+	 * @param probe
+	 * @param keyColumn
+	 * @param callback Invoked for each matching pair of records, in probe then build order, may be nullptr
+	 * @param outer Also invoke callback for probe records without a match (left outer join)
+	 * @retval unsigned Number of times callback was invoked
+	 */
+	unsigned join(Reader& probe, unsigned keyColumn, Callback callback, bool outer = false);
+
+	/**
+	 * @brief Release build table
+	 */
+	void clear();
+
+	/**
+	 * @brief Get reason for failure of last `build()`
+	 */
+	Error getError() const
+	{
+		return error;
+	}
+
+	/**
+	 * @brief Get number of records in build table
+	 */
+	unsigned count() const
+	{
+		return entries.size();
+	}
+
+	/**
+	 * @brief Get memory used by build table
+	 */
+	size_t getMemoryUsed() const
+	{
+		return arena.getCapacity() + entries.capacity() * sizeof(Entry) + index.getMemoryUsed();
+	}
+
+private:
+	/*
+	 * Stored row contains key followed by requested fields
+	 */
+	struct Entry {
+		ArenaRow row;
+		int start;
+		uint32_t hash;
+	};
+
+	Error add(const Reader& reader, unsigned keyColumn, const std::vector<unsigned>& columns);
+	bool checkMemory() const
+	{
+		return maxBytes == 0 || getMemoryUsed() <= maxBytes;
+	}
+
+	Arena arena{4096};
+	std::vector<Entry> entries;
+	HashIndex<> index;
+	size_t maxBytes;
+	Error error{};
+};
+
+} // namespace CSV
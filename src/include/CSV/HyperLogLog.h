@@ -0,0 +1,97 @@
+/****
+ * HyperLogLog.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include <WString.h>
+#include <vector>
+#include <algorithm>
+
+namespace CSV
+{
+/**
+ * @brief Estimate number of distinct values using fixed memory
+ *
+ * Uses the HyperLogLog algorithm with 32-bit xxHash values.
+ * Memory use is 2^precision bytes, with a typical relative error of 1.04 / sqrt(2^precision):
+ * about 6.5% for the default precision of 8 (256 bytes) or 1.6% for precision 12 (4KB).
+ */
+class HyperLogLog
+{
+public:
+	static constexpr uint8_t minPrecision{4};
+	static constexpr uint8_t maxPrecision{16};
+
+	/**
+	 * @brief Construct an estimator
+	 * @param precision Number of hash bits used to select a register, clamped to supported range
+	 */
+	HyperLogLog(uint8_t precision = 8);
+
+	/**
+	 * @brief Account for a value
+	 */
+	void add(const char* value, size_t length);
+
+	void add(const char* value)
+	{
+		add(value, strlen(value));
+	}
+
+	/**
+	 * @brief Account for a pre-computed hash value
+	 * @param hash Obtained using `xxh32()`
+	 */
+	void addHash(uint32_t hash);
+
+	/**
+	 * @brief Combine values seen by another estimator into this one
+	 * @retval bool false if precision differs
+	 */
+	bool merge(const HyperLogLog& other);
+
+	/**
+	 * @brief Get estimated number of distinct values
+	 */
+	uint32_t estimate() const;
+
+	void clear()
+	{
+		std::fill(registers.begin(), registers.end(), 0);
+	}
+
+	uint8_t getPrecision() const
+	{
+		return precision;
+	}
+
+	/**
+	 * @brief Get number of bytes used for registers
+	 */
+	size_t getSize() const
+	{
+		return registers.size();
+	}
+
+private:
+	std::vector<uint8_t> registers;
+	uint8_t precision;
+};
+
+} // namespace CSV
@@ -0,0 +1,192 @@
+/****
+ * IncrementalParser.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "Parser.h"
+
+namespace CSV
+{
+/**
+ * @brief Parser which processes pushed data in time-limited slices
+ *
+ * Calling `Parser::push()` in a loop from a network callback can block the event loop for
+ * long periods if a large amount of data arrives at once, starving other tasks or tripping the watchdog.
+ *
+ * Instead, data is copied into a queue using `write()` and parsed by calling `process()`.
+ * This stops when the budget is exhausted and returns `Status::yield`, with all state retained so that
+ * the next call continues where it left off. Use `run()` to have this done via the system task queue.
+ *
+ * The queue grows if data is written faster than it is parsed, so check `getPending()` if flow control is required.
+ */
+class IncrementalParser : public Parser
+{
+public:
+	/**
+	 * @brief Result of processing
+	 */
+	enum class Status {
+		needData, ///< All queued data has been parsed, call `write()` or `end()` to continue
+		yield,	  ///< Budget exhausted, call `process()` again to continue
+		complete, ///< All records have been parsed following call to `end()`
+		aborted,  ///< Row callback returned false, or out of memory
+	};
+
+	/**
+	 * @brief Limits the amount of work done in one call to `process()`
+	 *
+	 * At least one record is always processed, if available.
+	 */
+	struct Budget {
+		size_t bytes = 1024; ///< Maximum number of source characters to parse, 0 for no limit
+		uint32_t time = 0;	 ///< Maximum time in microseconds, 0 for no limit
+	};
+
+	/**
+	 * @brief Callback invoked for each record
+	 * @param row The parsed record
+	 * @retval bool Return false to abort processing
+	 */
+	using RowCallback = Delegate<bool(const CStringArray& row)>;
+
+	/**
+	 * @brief Callback invoked by `run()` when processing has finished
+	 * @param status Either Status::complete or Status::aborted
+	 *
+	 * The parser may be destroyed from this callback.
+	 */
+	using CompleteCallback = Delegate<void(Status status)>;
+
+	/**
+	 * @brief Construct an incremental parser using default budget
+	 * @param options Parser options
+	 * @param onRow Callback for each record
+	 */
+	IncrementalParser(const Options& options, RowCallback onRow) : Parser(options), onRow(onRow)
+	{
+	}
+
+	/**
+	 * @brief Construct an incremental parser
+	 * @param options Parser options
+	 * @param onRow Callback for each record
+	 * @param budget Limit for each call to `process()`
+	 */
+	IncrementalParser(const Options& options, RowCallback onRow, const Budget& budget)
+		: Parser(options), onRow(onRow), budget(budget)
+	{
+	}
+
+	/**
+	 * @brief Queue source data for parsing
+	 * @param data Source data, copied
+	 * @param length Number of characters in data
+	 * @retval size_t Number of characters queued, less than length only if out of memory
+	 */
+	size_t write(const char* data, size_t length);
+
+	/**
+	 * @brief Indicate that all source data has been written
+	 *
+	 * Any final record without a line ending is then returned.
+	 */
+	void end()
+	{
+		finished = true;
+	}
+
+	/**
+	 * @brief Parse queued data using default budget
+	 */
+	Status process()
+	{
+		return process(budget);
+	}
+
+	/**
+	 * @brief Parse queued data
+	 * @param budget Limit on work done in this call
+	 * @retval Status
+	 */
+	Status process(const Budget& budget);
+
+	/**
+	 * @brief Set callback to be invoked when `run()` completes
+	 */
+	void onComplete(CompleteCallback callback)
+	{
+		completeCallback = callback;
+	}
+
+	/**
+	 * @brief Process queued data via the system task queue
+	 * @retval bool false if task could not be queued
+	 *
+	 * Each task calls `process()` and re-queues itself whilst it yields,
+	 * so other tasks get to run between each slice. Call again after `write()` or `end()`.
+	 * Does nothing if a task is already queued.
+	 *
+	 * @note The parser must not be destroyed whilst `isScheduled()` returns true
+	 */
+	bool run();
+
+	/**
+	 * @brief Determine if a task is queued to process data
+	 */
+	bool isScheduled() const
+	{
+		return scheduled;
+	}
+
+	/**
+	 * @brief Get the most recent result from `process()`
+	 */
+	Status getStatus() const
+	{
+		return status;
+	}
+
+	/**
+	 * @brief Get number of source characters queued but not yet parsed
+	 */
+	size_t getPending() const
+	{
+		return queue.length() - readPos;
+	}
+
+private:
+	/*
+	 * Parsed data is discarded from the queue once it reaches this size and exceeds the unparsed data,
+	 * so the cost of moving data is not incurred on every write
+	 */
+	static constexpr size_t compactThreshold{512};
+
+	void task();
+
+	RowCallback onRow;
+	CompleteCallback completeCallback;
+	Budget budget;
+	String queue;
+	size_t readPos{0}; ///< Offset of first unparsed character in queue
+	Status status{Status::needData};
+	bool finished{false};
+	bool scheduled{false};
+};
+
+} // namespace CSV
@@ -0,0 +1,123 @@
+/****
+ * Index.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "Reader.h"
+#include <vector>
+
+namespace CSV
+{
+/**
+ * @brief Sorted index on one column of a CSV file
+ *
+ * Each entry holds the leading characters of the key value plus the location of its record,
+ * so the index is small and lookups use a binary search.
+ * Matching records are fetched using `Reader::seek()` and the full key verified.
+ *
+ * An index can be saved and later re-loaded, provided the source data has not changed.
+ */
+class Index
+{
+public:
+	static constexpr unsigned prefixLength{8}; ///< Number of key characters stored in index
+
+	struct Entry {
+		char key[prefixLength]; ///< Start of key, NUL-padded
+		int start;				///< Cursor::start of record
+	};
+
+	/**
+	 * @brief Called for each record matching a lookup
+	 * @param reader Reader positioned on the matching record
+	 * @retval bool Return true to continue, false to stop
+	 */
+	using Callback = Delegate<bool(Reader& reader)>;
+
+	/**
+	 * @brief Build index by scanning all records
+	 * @param reader
+	 * @param column Index of key column
+	 * @retval bool false on error, such as out of memory
+	 * @note On return the reader is reset
+	 */
+	bool build(Reader& reader, unsigned column);
+
+	/**
+	 * @brief Find first record with matching key
+	 * @param reader Reader for the indexed data
+	 * @param key Value to find
+	 * @retval bool true if found, reader is positioned on the record
+	 */
+	bool find(Reader& reader, const char* key) const;
+
+	/**
+	 * @brief Find all records whose key starts with a given prefix
+	 * @param reader Reader for the indexed data
+	 * @param prefix Start of key value, empty to match all records
+	 * @param callback Invoked for each matching record
+	 * @note Records are ordered by the indexed key characters, then by position in file
+	 * @retval unsigned Number of matches
+	 */
+	unsigned findPrefix(Reader& reader, const char* prefix, Callback callback) const;
+
+	/**
+	 * @brief Write index to a stream
+	 * @retval bool true on success
+	 */
+	bool save(Print& out) const;
+
+	/**
+	 * @brief Read index previously written by `save()`
+	 * @retval bool false if data is invalid, index is left empty
+	 */
+	bool load(Stream& in);
+
+	void clear()
+	{
+		entries.clear();
+	}
+
+	/**
+	 * @brief Get number of entries
+	 */
+	unsigned count() const
+	{
+		return entries.size();
+	}
+
+	/**
+	 * @brief Get index of key column
+	 */
+	unsigned getColumn() const
+	{
+		return column;
+	}
+
+private:
+	using Iterator = std::vector<Entry>::const_iterator;
+
+	std::pair<Iterator, Iterator> range(const char* prefix) const;
+	unsigned lookup(Reader& reader, const char* key, bool exact, Callback callback) const;
+
+	std::vector<Entry> entries;
+	unsigned column{0};
+};
+
+} // namespace CSV
@@ -0,0 +1,83 @@
+/****
+ * MappedFile.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#if defined(ARCH_HOST) && !defined(__WIN32)
+
+#include <cstddef>
+
+namespace CSV
+{
+/**
+ * @brief Read-only memory mapping of a file
+ *
+ * Allows a ColumnFile to be used directly from disk: pages are loaded on demand
+ * and only those containing the columns accessed are read.
+ * The mapping is page-aligned so meets the ColumnFile alignment requirement.
+ *
+ * @note Available in host builds on POSIX systems only. Filenames are native paths.
+ */
+class MappedFile
+{
+public:
+	/**
+	 * @brief Map a file
+	 * @param filename
+	 */
+	MappedFile(const char* filename);
+
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	/**
+	 * @brief Determine if file was mapped successfully
+	 */
+	explicit operator bool() const
+	{
+		return data != nullptr;
+	}
+
+	/**
+	 * @brief Get mapped content
+	 * @retval const void* nullptr if mapping failed
+	 */
+	const void* getData() const
+	{
+		return data;
+	}
+
+	/**
+	 * @brief Get size of mapped content
+	 */
+	size_t getLength() const
+	{
+		return length;
+	}
+
+private:
+	void* data{nullptr};
+	size_t length{0};
+};
+
+} // namespace CSV
+
+#endif // ARCH_HOST && !__WIN32
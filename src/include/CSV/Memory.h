@@ -0,0 +1,67 @@
+/****
+ * Memory.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+
+namespace CSV
+{
+/**
+ * @brief Reserve capacity in a vector, failing if memory is not available
+ * @param vec
+ * @param capacity Required number of elements
+ * @retval bool false if allocation would fail, vector is unchanged
+ *
+ * Without exceptions std::vector cannot report allocation failure, so the
+ * required block is first obtained and released using malloc.
+ */
+template <typename T> bool reserve(std::vector<T>& vec, size_t capacity)
+{
+	if(capacity <= vec.capacity()) {
+		return true;
+	}
+	if(capacity > vec.max_size()) {
+		return false;
+	}
+	auto mem = malloc(capacity * sizeof(T));
+	if(mem == nullptr) {
+		return false;
+	}
+	free(mem);
+	vec.reserve(capacity);
+	return true;
+}
+
+/**
+ * @brief Append an element to a vector, failing if memory is not available
+ * @retval bool false on allocation failure
+ */
+template <typename T> bool append(std::vector<T>& vec, const T& value)
+{
+	if(vec.size() == vec.capacity() && !reserve(vec, std::max(size_t(16), vec.size() * 2))) {
+		return false;
+	}
+	vec.push_back(value);
+	return true;
+}
+
+} // namespace CSV
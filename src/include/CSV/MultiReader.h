@@ -0,0 +1,167 @@
+/****
+ * MultiReader.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "Reader.h"
+
+namespace CSV
+{
+/**
+ * @brief Read a sequence of CSV sources (shards) as a single table
+ *
+ * All shards must have the same structure. If headings are not provided in the constructor
+ * they are read from the first shard, and every other shard must start with identical headings.
+ * A single parser buffer is used for all shards.
+ *
+ * Shards are opened on demand via callback. By default the following shard is opened
+ * as soon as reading of the current one starts, so any latency in opening it can be hidden
+ * (e.g. by starting a network request) whilst the current shard is processed.
+ */
+class MultiReader
+{
+public:
+	/**
+	 * @brief Callback to open a shard
+	 * @param shard Index of shard to open, from 0
+	 * @retval IDataSourceStream* Reader takes ownership, nullptr if there are no more shards
+	 */
+	using OpenShard = Delegate<IDataSourceStream*(unsigned shard)>;
+
+	/**
+	 * @brief Identifies a record within the table
+	 */
+	struct Position {
+		unsigned shard; ///< Shard index
+		int offset;		///< Record offset within shard, or BOF
+	};
+
+	/**
+	 * @brief Construct a reader
+	 * @param openShard Callback to open shards
+	 * @param options Parser options used for all shards
+	 * @param headings Required if shards do not contain field headings as first row
+	 * @param prefetch Set to false to open shards only when they are required
+	 */
+	MultiReader(OpenShard openShard, const Parser::Options& options, const CStringArray& headings = nullptr,
+				bool prefetch = true);
+
+	/**
+	 * @brief Construct a reader for a list of files
+	 * @param filenames Files to read, in order
+	 * @param options Parser options used for all files
+	 * @param headings Required if files do not contain field headings as first row
+	 * @note Reading stops at the first file which cannot be opened
+	 */
+	MultiReader(const CStringArray& filenames, const Parser::Options& options,
+				const CStringArray& headings = nullptr);
+
+	/**
+	 * @brief Reset reader to start of first shard
+	 */
+	void reset()
+	{
+		seek(Position{0, Parser::BOF});
+	}
+
+	/**
+	 * @brief Seek to next record, moving to the following shard as required
+	 * @retval bool true on success, false if there are no more records
+	 */
+	bool next();
+
+	/**
+	 * @brief Get position of current record
+	 */
+	Position tell() const
+	{
+		return Position{shard, reader.tell()};
+	}
+
+	/**
+	 * @brief Set reader to previously noted position
+	 * @param pos Value obtained via `tell()`
+	 * @retval bool true on success, false on failure or end of records
+	 * @note Shard streams must support random seeking (seekFrom)
+	 * @see See `Reader::seek()`
+	 */
+	bool seek(const Position& pos);
+
+	/**
+	 * @brief Get index of the current shard
+	 */
+	unsigned getShard() const
+	{
+		return shard;
+	}
+
+	/**
+	 * @brief Get number of columns
+	 */
+	unsigned count() const
+	{
+		return reader.count();
+	}
+
+	const CStringArray& getRow() const
+	{
+		return reader.getRow();
+	}
+
+	const char* getValue(unsigned index) const
+	{
+		return reader.getValue(index);
+	}
+
+	const char* getValue(const char* name) const
+	{
+		return reader.getValue(name);
+	}
+
+	int getColumn(const char* name) const
+	{
+		return reader.getColumn(name);
+	}
+
+	const CStringArray& getHeadings() const
+	{
+		return reader.getHeadings();
+	}
+
+	/**
+	 * @brief Determine if reader is valid
+	 * @note Becomes false after the last shard or if a shard fails to open or has mismatched headings
+	 */
+	explicit operator bool() const
+	{
+		return bool(reader);
+	}
+
+private:
+	bool openShard(unsigned index);
+
+	OpenShard open;
+	Reader reader;
+	std::unique_ptr<IDataSourceStream> nextSource; ///< Prefetched shard following current one
+	unsigned shard{0};
+	bool prefetch;
+	bool prefetched{false}; ///< nextSource is valid
+};
+
+} // namespace CSV
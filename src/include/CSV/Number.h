@@ -0,0 +1,77 @@
+/****
+ * Number.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include <WString.h>
+#include <cstdint>
+
+namespace CSV
+{
+/**
+ * @brief Type of a field value, in order of generality
+ */
+enum class ValueType : uint8_t {
+	empty,   ///< Empty or whitespace only
+	integer, ///< Decimal integer
+	number,  ///< Floating-point number
+	text,	///< Anything else
+};
+
+/**
+ * @brief Number of ValueType values, for use as array size
+ */
+constexpr unsigned valueTypeCount{unsigned(ValueType::text) + 1};
+
+/**
+ * @brief Determine type of a field value
+ */
+ValueType getValueType(const char* value);
+
+/**
+ * @brief Get type able to represent values of both given types
+ */
+inline ValueType combine(ValueType type1, ValueType type2)
+{
+	return (type1 > type2) ? type1 : type2;
+}
+
+/**
+ * @brief Parse a decimal integer value
+ * @param str Field value, leading and trailing whitespace is ignored
+ * @param value On success, contains parsed value
+ * @retval bool false if field is empty, not an integer or out of range
+ */
+bool parseInteger(const char* str, int64_t& value);
+
+/**
+ * @brief Parse a decimal floating-point value
+ * @param str Field value, leading and trailing whitespace is ignored
+ * @param value On success, contains parsed value
+ * @retval bool false if field is empty or not a number
+ *
+ * Accepts optional sign, digits with optional decimal point and optional exponent.
+ * This is faster than `strtod()` as it handles only these simple forms,
+ * with results accurate to about 15 significant digits.
+ */
+bool parseNumber(const char* str, double& value);
+
+} // namespace CSV
+
+String toString(CSV::ValueType type);
@@ -0,0 +1,212 @@
+/****
+ * Parallel.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#ifdef ARCH_HOST
+
+#include "Pipeline.h"
+#include "Table.h"
+#include <deque>
+#include <mutex>
+#include <algorithm>
+#include <iterator>
+
+namespace CSV
+{
+/**
+ * @brief Process records from a reader on several threads using work stealing
+ *
+ * The calling thread parses records into batches and distributes them evenly between the workers.
+ * Each worker takes batches from its own queue, and when that is empty takes the oldest batch from
+ * another worker's queue. This keeps all threads busy when per-record processing time varies.
+ *
+ * Batches are processed in no particular order. As with Pipeline, a fixed set of batches is recycled.
+ *
+ * @note Available in host builds only
+ */
+class Scheduler
+{
+public:
+	using ProcessBatch = Pipeline::ProcessBatch;
+	using Settings = Pipeline::Settings;
+
+	Scheduler(Reader& reader, const Settings& settings);
+
+	Scheduler(Reader& reader) : Scheduler(reader, Settings{})
+	{
+	}
+
+	/**
+	 * @brief Process all remaining records from the reader
+	 * @param process Callback for each batch
+	 * @retval size_t Number of records processed
+	 */
+	size_t run(ProcessBatch process);
+
+	unsigned getThreadCount() const
+	{
+		return threadCount;
+	}
+
+	/**
+	 * @brief Get number of batches processed by a worker other than the one they were given to
+	 */
+	unsigned getStealCount() const
+	{
+		return stealCount;
+	}
+
+private:
+	/*
+	 * Batches are coarse-grained so a simple locked deque is sufficient
+	 */
+	struct alignas(64) WorkQueue {
+		std::mutex mutex;
+		std::deque<Batch*> batches;
+	};
+
+	void worker(unsigned index);
+	Batch* take(unsigned index);
+
+	Reader& reader;
+	unsigned threadCount;
+	unsigned batchSize;
+	unsigned batchCount;
+	std::unique_ptr<Batch[]> batches;
+	std::unique_ptr<WorkQueue[]> queues;
+	RingQueue<Batch*> freeQueue;
+	ProcessBatch process;
+	std::atomic<unsigned> pending{0};
+	std::atomic<bool> finished{false};
+	std::atomic<unsigned> stealCount{0};
+};
+
+/**
+ * @brief Apply a function to every remaining record in a table, in parallel
+ * @tparam Accumulator Per-worker state, must be copyable and provide `void merge(const Accumulator&)`
+ * @param table
+ * @param init Initial accumulator value, copied for each worker
+ * @param func Called on worker threads as `func(Accumulator&, const Record&)`
+ * @param settings
+ * @retval Accumulator Result of merging all worker accumulators into `init`
+ *
+ * Accumulators are not shared so need no locking.
+ *
+ * One Record is re-used for each batch, so once its buffer has grown to fit typical rows
+ * no further allocation takes place. The record passed to `func` is only valid for the duration of the call.
+ */
+template <class Record, class Accumulator, typename Func>
+Accumulator parallelForEach(Table<Record>& table, const Accumulator& init, Func func,
+							const Scheduler::Settings& settings = {})
+{
+	// Pad to avoid false sharing between workers
+	struct alignas(64) Slot {
+		Accumulator value;
+	};
+
+	Scheduler scheduler(table, settings);
+	std::vector<Slot> slots(scheduler.getThreadCount(), Slot{init});
+	scheduler.run([&](unsigned worker, const Batch& batch) {
+		auto& acc = slots[worker].value;
+		Record record;
+		for(unsigned i = 0; i < batch.count(); ++i) {
+			record.row = batch[i];
+			func(acc, record);
+		}
+	});
+
+	Accumulator result(init);
+	for(auto& slot : slots) {
+		result.merge(slot.value);
+	}
+	return result;
+}
+
+/**
+ * @brief Apply a function to every remaining record in a table, in parallel
+ * @param table
+ * @param func Called on worker threads as `func(const Record&)`
+ * @param settings
+ * @retval size_t Number of records processed
+ */
+template <class Record, typename Func>
+size_t parallelForEach(Table<Record>& table, Func func, const Scheduler::Settings& settings = {})
+{
+	Scheduler scheduler(table, settings);
+	return scheduler.run([&](unsigned, const Batch& batch) {
+		Record record;
+		for(unsigned i = 0; i < batch.count(); ++i) {
+			record.row = batch[i];
+			func(record);
+		}
+	});
+}
+
+/**
+ * @brief Transform every remaining record in a table, in parallel
+ * @tparam T Result type
+ * @param table
+ * @param func Called on worker threads as `T func(const Record&)`
+ * @param settings
+ * @retval std::vector<T> Results in source order
+ */
+template <typename T, class Record, typename Func>
+std::vector<T> parallelMap(Table<Record>& table, Func func, const Scheduler::Settings& settings = {})
+{
+	struct Chunk {
+		unsigned sequence;
+		std::vector<T> values;
+	};
+	struct alignas(64) Slot {
+		std::vector<Chunk> chunks;
+	};
+
+	Scheduler scheduler(table, settings);
+	std::vector<Slot> slots(scheduler.getThreadCount());
+	auto count = scheduler.run([&](unsigned worker, const Batch& batch) {
+		Chunk chunk{batch.sequence};
+		chunk.values.reserve(batch.count());
+		Record record;
+		for(unsigned i = 0; i < batch.count(); ++i) {
+			record.row = batch[i];
+			chunk.values.push_back(func(record));
+		}
+		slots[worker].chunks.push_back(std::move(chunk));
+	});
+
+	// Re-assemble results in batch order
+	std::vector<Chunk*> chunks;
+	for(auto& slot : slots) {
+		for(auto& chunk : slot.chunks) {
+			chunks.push_back(&chunk);
+		}
+	}
+	std::sort(chunks.begin(), chunks.end(), [](auto c1, auto c2) { return c1->sequence < c2->sequence; });
+	std::vector<T> result;
+	result.reserve(count);
+	for(auto chunk : chunks) {
+		std::move(chunk->values.begin(), chunk->values.end(), std::back_inserter(result));
+	}
+	return result;
+}
+
+} // namespace CSV
+
+#endif // ARCH_HOST
@@ -22,6 +22,7 @@
 #include <Delegate.h>
 #include <Data/CStringArray.h>
 #include <Data/Stream/DataSourceStream.h>
+#include <vector>
 
 namespace CSV
 {
@@ -72,8 +73,11 @@ struct Cursor {
  *
  * - Line breaks can be \n or \r\n
  * - Escapes codes within quoted fields can be converted: \n \r \t \", \\
- * - Field separator can be changed in constructor
+ * - Field separator can be changed in constructor, and additional separators specified
+ * - Quote character can be changed or quoting disabled
  * - Comment lines can be read and returned or discarded
+ * - Records without quotes are split using a fast path
+ * - Hashes of each field and record can be computed for change detection
  *
  * This is a 'push' parser so can handle source data of indefinite size.
  */
@@ -97,6 +101,14 @@ public:
 		 * or '\0' for whitespace-separated fields with leading/trailing whitespace discarded
 		 */
 		char fieldSeparator = ',';
+		/**
+		 * Optional list of additional field separator characters
+		 */
+		const char* fieldSeparators = nullptr;
+		/**
+		 * Character used to quote fields, or '\0' to disable quoting
+		 */
+		char quoteChar = '"';
 		/**
 		 * @brief Set to true to handle escape sequences (\n, \t, etc.)
 		 */
@@ -105,16 +117,52 @@ public:
 		 * @brief Set to true to return comment lines, otherwise they're discarded
 		 */
 		bool wantComments = false;
+		/**
+		 * @brief Set to false to always use the full parser
+		 *
+		 * Records without quotes, escapes, comments or embedded carriage returns
+		 * are split using a simple scan, with no per-character state tracking.
+		 * This is checked for each record, so is effective for data such as tab-separated files.
+		 */
+		bool fastPath = true;
+		/**
+		 * @brief Set to true to compute a hash for each field and record
+		 *
+		 * See `getHash()` and `getFieldHash()`.
+		 */
+		bool hashFields = false;
 	};
 
 	static constexpr int BOF{-1}; ///< Indicates 'Before First Record'
 
+	/**
+	 * @brief Saved parser state, used to resume processing after interruption
+	 */
+	struct Checkpoint {
+		Cursor cursor{BOF};	///< Location of current record
+		unsigned sourcePos{0}; ///< Number of source characters consumed, including `pending`
+		String pending;		   ///< Source data received but not yet parsed
+
+		/**
+		 * @brief Serialise checkpoint
+		 * @retval bool true on success
+		 */
+		bool save(Print& out) const;
+
+		/**
+		 * @brief De-serialise checkpoint written by `save()`
+		 * @retval bool false if data is invalid
+		 */
+		bool load(Stream& in);
+	};
+
 	/**
 	 * @brief Construct a CSV parser
 	 * @param options
 	 */
 	Parser(const Options& options) : options(options)
 	{
+		initCharClass();
 	}
 
 	/**
@@ -122,6 +170,11 @@ public:
 	 * @param source
 	 * @retval bool true if record available, false otherwise
 	 * @note Call `flush()` after all data pushed
+	 *
+	 * A record is returned as soon as it is known to be complete, which is when a line break
+	 * is buffered outside of quotes. If the data contains escapes or comment characters, or the
+	 * record is longer than the buffer, parsing waits until the buffer is full.
+	 * Results do not depend on how the source data is divided.
 	 */
 	bool push(Stream& source);
 
@@ -175,6 +228,51 @@ public:
 		return cursor.start;
 	}
 
+	/**
+	 * @brief Discard buffered data preceding a source position
+	 * @param pos Source position to continue parsing from
+	 * @param streamPos Current position of the source stream
+	 * @retval bool true if pos lies within buffered data, false if source must be re-read
+	 *
+	 * Used by Reader to seek forward without re-reading source data.
+	 * Buffered data is only valid if the source stream has not been moved since it was read,
+	 * so `streamPos` is checked for this.
+	 */
+	bool skipBuffered(unsigned pos, unsigned streamPos);
+
+	/**
+	 * @brief Set current row from a previously parsed copy
+	 * @param newRow Row content
+	 * @param newCursor Location of row
+	 * @param nextPos Stream position following row, where parsing continues
+	 * @note Used by Reader for cached records. The caller must position the source at `nextPos`.
+	 */
+	void setRow(const CStringArray& newRow, const Cursor& newCursor, unsigned nextPos);
+
+	/**
+	 * @brief Get hash of current row
+	 * @retval uint32_t 0 if there is no current row or hashing is disabled
+	 * @note Requires Options::hashFields
+	 *
+	 * This is computed from the field hashes so depends only on field values,
+	 * not on quoting or line endings in the source data.
+	 */
+	uint32_t getHash() const
+	{
+		return rowHash;
+	}
+
+	/**
+	 * @brief Get hash of a field in the current row
+	 * @param index Field index, starts at 0
+	 * @retval uint32_t xxh32 of field value, 0 if index is out of range or hashing is disabled
+	 * @note Requires Options::hashFields
+	 */
+	uint32_t getFieldHash(unsigned index) const
+	{
+		return (index < fieldHashes.size()) ? fieldHashes[index] : 0;
+	}
+
 	/**
 	 * @brief Get cursor position for current row
 	 */
@@ -196,17 +294,63 @@ public:
 		return options;
 	}
 
+	/**
+	 * @brief Get current parser state
+	 *
+	 * Includes any partial record data, so when using `push()` the checkpoint can be restored
+	 * and parsing continued by pushing source data from `Checkpoint::sourcePos` onwards.
+	 */
+	Checkpoint getCheckpoint() const;
+
+	/**
+	 * @brief Restore parser state from a checkpoint
+	 * @retval bool false if checkpoint is invalid for this parser, or out of memory
+	 * @note The current row is not restored, the next row returned will be the one following it
+	 */
+	bool restore(const Checkpoint& checkpoint);
+
 private:
+	/**
+	 * @brief Character classification bits, built from Options at construction
+	 */
+	enum CharClass : uint8_t {
+		cls_separator = 0x01,
+		cls_quote = 0x02,
+		cls_newline = 0x04,
+		cls_return = 0x08,
+		cls_escape = 0x10,
+		cls_comment = 0x20,
+		cls_space = 0x40,
+	};
+
+	void initCharClass();
+	size_t getBufferSize() const;
 	size_t fillBuffer(Stream* source);
 	bool parseRow(bool eof);
+	bool hasRecord();
+	bool parseUnquoted(unsigned& readpos, unsigned& writepos);
+	void hashRow();
 
 	Options options;
+	uint8_t charClass[256];
 	CStringArray row;
+	std::vector<uint32_t> fieldHashes;
+	uint32_t rowHash{0};
 	String buffer;
 	Cursor cursor{BOF};	///< Stream position for start of current row
 	unsigned sourcePos{0}; ///< Source stream position (including read-ahead buffering)
 	uint16_t tailpos{0};
 	uint16_t taillen{0};
+	/**
+	 * @brief Progress of `hasRecord()` through buffered data
+	 */
+	struct ScanState {
+		uint16_t pos;
+		bool quote : 1;
+		bool comment : 1;
+		bool inField : 1;
+	};
+	ScanState scan{};
 };
 
 } // namespace CSV
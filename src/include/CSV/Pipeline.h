@@ -0,0 +1,110 @@
+/****
+ * Pipeline.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#ifdef ARCH_HOST
+
+#include "Batch.h"
+#include "RingQueue.h"
+#include <thread>
+
+namespace CSV
+{
+/**
+ * @brief Parse records on one thread and process them on several others
+ *
+ * The calling thread reads records into batches which are passed via a lock-free queue to worker threads.
+ * A fixed set of batches circulates between the reader and the workers: when all batches are in use the
+ * reader waits for one to be returned, which bounds memory usage and provides backpressure.
+ * Idle threads sleep rather than spin.
+ *
+ * @note Available in host builds only
+ */
+class Pipeline
+{
+public:
+	/**
+	 * @brief Called on a worker thread to process a batch
+	 * @param worker Index of worker thread, from 0
+	 * @param batch
+	 */
+	using ProcessBatch = Delegate<void(unsigned worker, const Batch& batch)>;
+
+	/**
+	 * @brief Called after processing to complete batches in source order
+	 * @note Calls are serialised, but may happen on any worker thread
+	 */
+	using CompleteBatch = Delegate<void(const Batch& batch)>;
+
+	struct Settings {
+		/**
+		 * Number of worker threads, 0 to use one per hardware thread
+		 */
+		unsigned threads = 0;
+		/**
+		 * Maximum number of records per batch
+		 */
+		unsigned batchSize = 64;
+		/**
+		 * Number of batches to allocate, 0 to use twice the number of threads
+		 */
+		unsigned batchCount = 0;
+	};
+
+	Pipeline(Reader& reader, const Settings& settings);
+
+	Pipeline(Reader& reader) : Pipeline(reader, Settings{})
+	{
+	}
+
+	/**
+	 * @brief Process all remaining records from the reader
+	 * @param process Callback for each batch
+	 * @param complete Optional callback for in-order completion
+	 * @retval size_t Number of records processed
+	 */
+	size_t run(ProcessBatch process, CompleteBatch complete = nullptr);
+
+	unsigned getThreadCount() const
+	{
+		return threadCount;
+	}
+
+private:
+	void worker(unsigned index);
+	void waitTurn(unsigned sequence);
+
+	Reader& reader;
+	unsigned threadCount;
+	unsigned batchSize;
+	unsigned batchCount;
+	std::unique_ptr<Batch[]> batches;
+	RingQueue<Batch*> freeQueue;
+	RingQueue<Batch*> fullQueue;
+	ProcessBatch process;
+	CompleteBatch complete;
+	std::atomic<unsigned> nextComplete{0}; ///< Sequence of next batch to complete, updated under completeMutex
+	std::mutex completeMutex;
+	std::condition_variable completeSignal;
+};
+
+} // namespace CSV
+
+#endif // ARCH_HOST
@@ -0,0 +1,187 @@
+/****
+ * Profiler.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "Reader.h"
+#include "Batch.h"
+#include "Aggregate.h"
+#include "HyperLogLog.h"
+
+namespace CSV
+{
+/**
+ * @brief Distribution of lengths using power-of-2 bins
+ *
+ * Bin 0 counts zero lengths, bin n counts lengths from 2^(n-1) to 2^n - 1.
+ * The last bin also counts any longer values.
+ */
+struct LengthHistogram {
+	static constexpr unsigned binCount{17};
+
+	uint32_t bins[binCount]{};
+	uint32_t count{0};
+	uint32_t min{0};
+	uint32_t max{0};
+
+	void add(size_t length);
+
+	void merge(const LengthHistogram& other);
+
+	/**
+	 * @brief Get length not exceeded by a given proportion of values
+	 * @param fraction Proportion of values, from 0 to 1
+	 * @retval size_t Upper limit of bin containing the requested value, not more than `max`
+	 */
+	size_t getLength(float fraction) const;
+};
+
+/**
+ * @brief Collect statistics about each column of a data set in a single pass
+ *
+ * Memory use is fixed per column, regardless of the number of records.
+ * Use the results to size parser buffers (Options::lineLength), choose encodings
+ * and check new data feeds before loading them.
+ *
+ * For parallel operation (see Pipeline) use one instance per worker then `merge()` the results.
+ */
+class Profiler
+{
+public:
+	struct Column {
+		uint32_t nullCount{0};				   ///< Number of records without this field
+		uint32_t typeCounts[valueTypeCount]{}; ///< Number of values of each ValueType
+		Stats numbers;						   ///< Count of values present, with statistics for numeric values
+		LengthHistogram lengths;			   ///< Lengths of values present
+		HyperLogLog distinct;				   ///< Estimator for number of distinct non-empty values
+
+		Column(uint8_t precision) : distinct(precision)
+		{
+		}
+
+		/**
+		 * @brief Get number of empty or whitespace-only values
+		 */
+		uint32_t getEmptyCount() const
+		{
+			return typeCounts[unsigned(ValueType::empty)];
+		}
+
+		/**
+		 * @brief Get type able to represent all non-empty values
+		 * @retval ValueType empty if there are no values
+		 */
+		ValueType getType() const;
+
+		/**
+		 * @brief Get estimated number of distinct non-empty values
+		 */
+		uint32_t getCardinality() const
+		{
+			return distinct.estimate();
+		}
+	};
+
+	/**
+	 * @brief Construct a profiler
+	 * @param precision Determines accuracy and size of distinct value estimators, see HyperLogLog
+	 */
+	Profiler(uint8_t precision = 8) : precision(precision)
+	{
+	}
+
+	/**
+	 * @brief Account for a single record
+	 * @param row
+	 * @param recordLength Size of record in source data, if known
+	 */
+	void add(const CStringArray& row, size_t recordLength = 0)
+	{
+		addRow(row, recordLength ?: row.length(), nullptr);
+	}
+
+	/**
+	 * @brief Account for all records in a batch
+	 */
+	void add(const Batch& batch);
+
+	/**
+	 * @brief Account for all remaining records from a reader
+	 * @retval size_t Number of records read
+	 *
+	 * If the reader has Options::hashFields set then its field hashes are used.
+	 */
+	size_t run(Reader& reader);
+
+	/**
+	 * @brief Combine results from another instance into this one
+	 * @retval bool false if precision differs
+	 */
+	bool merge(const Profiler& other);
+
+	/**
+	 * @brief Discard all results
+	 */
+	void clear()
+	{
+		columns.clear();
+		recordLengths = {};
+		recordCount = 0;
+	}
+
+	/**
+	 * @brief Get number of columns seen
+	 */
+	unsigned count() const
+	{
+		return columns.size();
+	}
+
+	const Column& operator[](unsigned index) const
+	{
+		return columns[index];
+	}
+
+	/**
+	 * @brief Get number of records seen
+	 */
+	uint32_t getRecordCount() const
+	{
+		return recordCount;
+	}
+
+	/**
+	 * @brief Get distribution of record lengths
+	 */
+	const LengthHistogram& getRecordLengths() const
+	{
+		return recordLengths;
+	}
+
+private:
+	void addRow(const CStringArray& row, size_t recordLength, const Reader* reader);
+	void addColumns(unsigned count);
+
+	std::vector<Column> columns;
+	LengthHistogram recordLengths;
+	uint32_t recordCount{0};
+	uint8_t precision;
+};
+
+} // namespace CSV
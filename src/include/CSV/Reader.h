@@ -20,6 +20,7 @@
 #pragma once
 
 #include "Parser.h"
+#include "RecordCache.h"
 #include <memory>
 
 namespace CSV
@@ -80,6 +81,32 @@ public:
 		return source ? readRow(*source) : false;
 	}
 
+	/**
+	 * @brief Seek to previous record
+	 * @retval bool true on success, false if there are no previous records
+	 *
+	 * If there is no current record because `next()` has returned false, this
+	 * fetches the last record. Otherwise when called on the first record the reader
+	 * is reset so there is no current record.
+	 *
+	 * @see See `last()` for details of operation
+	 */
+	bool prev();
+
+	/**
+	 * @brief Seek to last record
+	 * @retval bool true on success, false if there are no records
+	 *
+	 * The source is scanned backwards in small blocks to find the start of the record,
+	 * so the cost is proportional to record size rather than file size.
+	 * Line breaks within quoted fields are excluded by tracking quotes whilst scanning.
+	 * Each candidate boundary is then validated by re-parsing forward to the known following
+	 * record (or end of data), with a fall back to the first record if none is valid.
+	 *
+	 * @note Source stream must support random seeking (seekFrom)
+	 */
+	bool last();
+
 	/**
 	 * @brief Get number of columns
 	 */
@@ -140,9 +167,14 @@ public:
 
 	using Parser::tell;
 
+	using Parser::getFieldHash;
+	using Parser::getHash;
+	using Parser::getOptions;
+
 	/**
 	 * @brief Set reader to previously noted position
 	 * @param offset Value obtained via `tell()` or Cursor::start
+	 * @param useCache Set false to bypass the record cache, such as when scanning blocks of records
 	 * @retval bool true on success, false on failure or end of records
 	 * @note Source stream must support random seeking (seekFrom)
 	 *
@@ -150,18 +182,85 @@ public:
 	 * This is the same as if `next()` were called.
 	 *
 	 * Otherwise the corresponding row will be available via `getRow()`.
+	 *
+	 * If the target is within data already buffered by the parser, such as the following record,
+	 * then the source is not re-read. See also CachedStream.
 	 */
-	bool seek(int offset);
+	bool seek(int offset, bool useCache = true);
 
 	bool seek(const Cursor& cursor)
 	{
 		return seek(cursor.start);
 	}
 
+	/**
+	 * @brief Continue reading from another source with the same structure
+	 * @param newSource Stream to read, reader takes ownership
+	 * @retval bool false if source is invalid or its headings don't match
+	 *
+	 * The parser buffer is retained. If headings were read from the original source they
+	 * are read from the new source and checked, otherwise the new source must contain only data.
+	 * On failure the reader is left with no source.
+	 */
+	bool setSource(IDataSourceStream* newSource);
+
+	/**
+	 * @brief Enable caching of records fetched by `seek()`
+	 * @param maxBytes Memory to use for cached records, 0 to disable caching
+	 *
+	 * Repeated seeks to the same record then return a copy of the cached row without
+	 * reading or parsing the source. Records read using `next()` are not cached,
+	 * nor are those visited by `prev()` or `last()`.
+	 */
+	void setCacheSize(size_t maxBytes)
+	{
+		cache.reset(maxBytes ? new RecordCache(maxBytes) : nullptr);
+	}
+
+	/**
+	 * @brief Get the record cache, if enabled
+	 */
+	const RecordCache* getCache() const
+	{
+		return cache.get();
+	}
+
+	using Parser::Checkpoint;
+
+	/**
+	 * @brief Get checkpoint for current position
+	 * @note Source is re-read on restore so pending data is not included
+	 */
+	Checkpoint getCheckpoint() const
+	{
+		return Checkpoint{getCursor(), getStreamPos()};
+	}
+
+	/**
+	 * @brief Resume reading from a checkpoint
+	 * @param checkpoint Obtained via `getCheckpoint()` from a reader on the same source data
+	 * @retval bool true on success
+	 *
+	 * The reader is left in the same state as when the checkpoint was taken,
+	 * so calling `next()` continues with the following record.
+	 * A checkpoint taken before the first record (BOF) restores successfully with no current record,
+	 * as for `seek()`.
+	 */
+	bool restore(const Checkpoint& checkpoint)
+	{
+		return seek(checkpoint.cursor);
+	}
+
 private:
+	bool seekPrevious(int target);
+	int findPrevious(unsigned target);
+	int checkBoundary(unsigned pos, unsigned target);
+
 	std::unique_ptr<IDataSourceStream> source;
+	std::unique_ptr<RecordCache> cache;
 	CStringArray headings;
-	unsigned start{0}; ///< Stream position of first record
+	unsigned start{0};			///< Stream position of first record
+	bool sourceHeadings{false}; ///< Headings are present in source data
 };
 
 } // namespace CSV
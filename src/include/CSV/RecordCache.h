@@ -0,0 +1,118 @@
+/****
+ * RecordCache.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "Parser.h"
+#include <vector>
+
+namespace CSV
+{
+/**
+ * @brief Bounded cache of parsed records, keyed by source position
+ *
+ * Used by Reader to satisfy repeated `seek()` calls for the same records without re-reading the source.
+ * Memory usage is limited to a byte budget, with least-recently-used records discarded first.
+ * Lookup is a linear search so this is intended for a modest number of frequently used records.
+ */
+class RecordCache
+{
+public:
+	struct Entry {
+		Cursor cursor;
+		unsigned nextPos; ///< Stream position following record
+		uint32_t lastUse;
+		CStringArray row;
+	};
+
+	/**
+	 * @brief Construct a cache
+	 * @param maxBytes Maximum memory to use for cached rows, including overheads
+	 */
+	RecordCache(size_t maxBytes) : maxBytes(maxBytes)
+	{
+	}
+
+	/**
+	 * @brief Find a cached record
+	 * @param start Source position of record
+	 * @retval const Entry* nullptr if record is not cached
+	 */
+	const Entry* find(int start);
+
+	/**
+	 * @brief Add a record to the cache
+	 * @param cursor Location of record
+	 * @param nextPos Stream position following record
+	 * @param row Record content
+	 * @retval bool false if record is too large to cache or out of memory
+	 */
+	bool add(const Cursor& cursor, unsigned nextPos, const CStringArray& row);
+
+	/**
+	 * @brief Discard all cached records
+	 */
+	void clear()
+	{
+		entries.clear();
+		usedBytes = 0;
+	}
+
+	unsigned count() const
+	{
+		return entries.size();
+	}
+
+	size_t getUsed() const
+	{
+		return usedBytes;
+	}
+
+	size_t getCapacity() const
+	{
+		return maxBytes;
+	}
+
+	unsigned getHitCount() const
+	{
+		return hitCount;
+	}
+
+	unsigned getMissCount() const
+	{
+		return missCount;
+	}
+
+private:
+	static size_t getEntrySize(const CStringArray& row)
+	{
+		return sizeof(Entry) + row.length();
+	}
+
+	void evict();
+
+	std::vector<Entry> entries;
+	size_t maxBytes;
+	size_t usedBytes{0};
+	uint32_t useCount{0};
+	unsigned hitCount{0};
+	unsigned missCount{0};
+};
+
+} // namespace CSV
@@ -0,0 +1,197 @@
+/****
+ * RingQueue.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+namespace CSV
+{
+/**
+ * @brief Bounded lock-free multi-producer/multi-consumer queue
+ * @tparam T Element type, typically a pointer
+ *
+ * Based on Dmitry Vyukov's bounded MPMC queue.
+ * Each cell carries a sequence number so producers and consumers only contend on their own index.
+ *
+ * The blocking `push()` and `pop()` methods spin briefly, then sleep on a condition variable.
+ * The mutex is only taken when a thread is actually waiting.
+ */
+template <typename T> class RingQueue
+{
+public:
+	/**
+	 * @brief Construct a queue
+	 * @param capacity Maximum number of elements, rounded up to a power of 2
+	 */
+	RingQueue(size_t capacity)
+	{
+		size_t size{2};
+		while(size < capacity) {
+			size <<= 1;
+		}
+		mask = size - 1;
+		cells.reset(new Cell[size]);
+		for(size_t i = 0; i < size; ++i) {
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	/**
+	 * @brief Add an element to the queue if there is space
+	 * @retval bool false if queue is full
+	 */
+	bool tryPush(const T& value)
+	{
+		if(!enqueue(value)) {
+			return false;
+		}
+		wake(popWaiters, notEmpty);
+		return true;
+	}
+
+	/**
+	 * @brief Remove an element from the queue if one is available
+	 * @retval bool false if queue is empty
+	 */
+	bool tryPop(T& value)
+	{
+		if(!dequeue(value)) {
+			return false;
+		}
+		wake(pushWaiters, notFull);
+		return true;
+	}
+
+	/**
+	 * @brief Add an element, waiting for space if the queue is full
+	 */
+	void push(const T& value)
+	{
+		wait(pushWaiters, notFull, [&]() { return enqueue(value); });
+		wake(popWaiters, notEmpty);
+	}
+
+	/**
+	 * @brief Remove an element, waiting until one becomes available
+	 */
+	T pop()
+	{
+		T value;
+		wait(popWaiters, notEmpty, [&]() { return dequeue(value); });
+		wake(pushWaiters, notFull);
+		return value;
+	}
+
+private:
+	struct Cell {
+		std::atomic<size_t> sequence;
+		T data;
+	};
+
+	// Attempts made before a blocking call sleeps
+	static constexpr unsigned spinCount{64};
+
+	bool enqueue(const T& value)
+	{
+		Cell* cell;
+		size_t pos = enqueuePos.load(std::memory_order_relaxed);
+		for(;;) {
+			cell = &cells[pos & mask];
+			size_t seq = cell->sequence.load(std::memory_order_acquire);
+			intptr_t diff = intptr_t(seq) - intptr_t(pos);
+			if(diff == 0) {
+				if(enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if(diff < 0) {
+				return false;
+			} else {
+				pos = enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+		cell->data = value;
+		cell->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool dequeue(T& value)
+	{
+		Cell* cell;
+		size_t pos = dequeuePos.load(std::memory_order_relaxed);
+		for(;;) {
+			cell = &cells[pos & mask];
+			size_t seq = cell->sequence.load(std::memory_order_acquire);
+			intptr_t diff = intptr_t(seq) - intptr_t(pos + 1);
+			if(diff == 0) {
+				if(dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if(diff < 0) {
+				return false;
+			} else {
+				pos = dequeuePos.load(std::memory_order_relaxed);
+			}
+		}
+		value = cell->data;
+		cell->sequence.store(pos + mask + 1, std::memory_order_release);
+		return true;
+	}
+
+	template <typename Func> void wait(std::atomic<unsigned>& waiters, std::condition_variable& cond, Func attempt)
+	{
+		for(unsigned i = 0; i < spinCount; ++i) {
+			if(attempt()) {
+				return;
+			}
+		}
+		std::unique_lock<std::mutex> lock(mutex);
+		waiters.fetch_add(1);
+		// Pairs with fence in wake(): either we see the change or the waker sees our count
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		while(!attempt()) {
+			cond.wait(lock);
+		}
+		waiters.fetch_sub(1);
+	}
+
+	void wake(std::atomic<unsigned>& waiters, std::condition_variable& cond)
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if(waiters.load(std::memory_order_relaxed) != 0) {
+			std::lock_guard<std::mutex> lock(mutex);
+			cond.notify_one();
+		}
+	}
+
+	std::unique_ptr<Cell[]> cells;
+	size_t mask;
+	alignas(64) std::atomic<size_t> enqueuePos{0};
+	alignas(64) std::atomic<size_t> dequeuePos{0};
+	std::mutex mutex;
+	std::condition_variable notEmpty;
+	std::condition_variable notFull;
+	std::atomic<unsigned> pushWaiters{0};
+	std::atomic<unsigned> popWaiters{0};
+};
+
+} // namespace CSV
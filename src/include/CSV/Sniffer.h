@@ -0,0 +1,70 @@
+/****
+ * Sniffer.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "Reader.h"
+#include "Number.h"
+#include <vector>
+
+namespace CSV
+{
+/**
+ * @brief Infer parser options and column types from a sample of source data
+ *
+ * A bounded prefix of the source is read and parsed using each candidate field separator.
+ * The separator giving the most consistent number of fields per record is chosen.
+ * Comment characters, quoting, line endings, line length, presence of headings and
+ * column types are also inferred. The source is then rewound so no data is lost.
+ */
+class Sniffer
+{
+public:
+	struct Result {
+		Parser::Options options;
+		std::vector<ValueType> columnTypes; ///< Inferred type of each column
+		bool hasHeadings{false};			///< true if first record appears to contain column names
+		bool crlf{false};					///< Line endings are \r\n
+		bool quoted{false};					///< At least one quoted field was seen
+		unsigned recordCount{0};			///< Number of records in sample
+	};
+
+	/**
+	 * @brief Analyse source data
+	 * @param source Stream to analyse, must support seeking
+	 * @param result On success, contains inferred settings
+	 * @param sampleSize Maximum number of characters to read
+	 * @retval bool false if sample contains no records or source cannot be rewound
+	 */
+	static bool sniff(IDataSourceStream& source, Result& result, size_t sampleSize = 2048);
+
+	/**
+	 * @brief Analyse source data and construct a Reader for it
+	 * @param source Stream to read, reader takes ownership
+	 * @param result On success, contains inferred settings
+	 * @param sampleSize Maximum number of characters to read
+	 * @retval Reader* nullptr on failure
+	 *
+	 * If the data does not appear to contain headings, columns are named "1", "2", etc.
+	 */
+	static std::unique_ptr<Reader> createReader(IDataSourceStream* source, Result& result,
+												size_t sampleSize = 2048);
+};
+
+} // namespace CSV
@@ -0,0 +1,218 @@
+/****
+ * StringPool.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "Reader.h"
+#include "Arena.h"
+#include "HashIndex.h"
+#include <vector>
+
+namespace CSV
+{
+/**
+ * @brief Store unique copies of strings, each identified by a small integer
+ *
+ * Strings are held in an Arena with a hash table for lookup, so adding a string which
+ * is already present does not allocate. Two strings in the same pool are equal
+ * if and only if their identifiers are equal.
+ */
+class StringPool
+{
+public:
+	/**
+	 * @brief Identifies a string in the pool
+	 */
+	using Id = uint16_t;
+
+	/**
+	 * @brief Used for nullptr (e.g. missing field) and on failure
+	 */
+	static constexpr Id none{0};
+
+	/**
+	 * @brief Add a string to the pool, if not already present
+	 * @param value
+	 * @param length Number of characters in value
+	 * @retval Id `none` if value is nullptr, the pool is full or out of memory
+	 */
+	Id add(const char* value, size_t length);
+
+	Id add(const char* value)
+	{
+		return value ? add(value, strlen(value)) : none;
+	}
+
+	/**
+	 * @brief Find an existing string
+	 * @retval Id `none` if not found
+	 */
+	Id find(const char* value) const;
+
+	/**
+	 * @brief Get string given its identifier
+	 * @retval const char* nullptr if id is `none` or invalid
+	 */
+	const char* operator[](Id id) const
+	{
+		return (id != none && id <= entries.size()) ? entries[id - 1].value : nullptr;
+	}
+
+	/**
+	 * @brief Get length of a string given its identifier
+	 */
+	size_t getLength(Id id) const
+	{
+		return (id != none && id <= entries.size()) ? entries[id - 1].length : 0;
+	}
+
+	/**
+	 * @brief Get number of strings in pool
+	 */
+	unsigned count() const
+	{
+		return entries.size();
+	}
+
+	/**
+	 * @brief Get number of bytes used for string storage
+	 */
+	size_t getUsed() const
+	{
+		return arena.getUsed();
+	}
+
+	/**
+	 * @brief Discard all strings
+	 */
+	void clear();
+
+private:
+	struct Entry {
+		const char* value; ///< NUL-terminated
+		uint16_t length;
+		uint32_t hash;
+	};
+
+	Id lookup(const char* value, size_t length, uint32_t hash) const;
+
+	Arena arena;
+	std::vector<Entry> entries;
+	HashIndex<Id> index;
+};
+
+/**
+ * @brief Retain rows as string identifiers
+ *
+ * Where values repeat, such as country codes or time zone names,
+ * this needs far less memory than retaining copies of each row.
+ * Values may be compared for equality using their identifiers.
+ */
+class InternTable
+{
+public:
+	using Id = StringPool::Id;
+
+	/**
+	 * @brief Construct a table
+	 * @param columnCount Number of values stored for each row, additional values are discarded
+	 */
+	InternTable(unsigned columnCount) : columnCount(columnCount)
+	{
+	}
+
+	/**
+	 * @brief Add a row
+	 * @retval bool false if out of memory
+	 */
+	bool add(const CStringArray& row);
+
+	/**
+	 * @brief Add all remaining records from a reader
+	 * @retval size_t Number of records added
+	 */
+	size_t load(Reader& reader);
+
+	/**
+	 * @brief Get number of rows
+	 */
+	unsigned count() const
+	{
+		return columnCount ? ids.size() / columnCount : 0;
+	}
+
+	unsigned getColumnCount() const
+	{
+		return columnCount;
+	}
+
+	/**
+	 * @brief Get identifier for a value
+	 * @retval Id `none` if row or column are invalid, or value is missing
+	 */
+	Id getId(unsigned row, unsigned column) const
+	{
+		return (row < count() && column < columnCount) ? ids[row * columnCount + column] : StringPool::none;
+	}
+
+	/**
+	 * @brief Get a value
+	 * @retval const char* nullptr if row or column are invalid, or value is missing
+	 */
+	const char* getValue(unsigned row, unsigned column) const
+	{
+		return pool[getId(row, column)];
+	}
+
+	/**
+	 * @brief Get copy of a row
+	 */
+	CStringArray getRow(unsigned row) const;
+
+	/**
+	 * @brief Find first row with a matching value
+	 * @param column
+	 * @param value
+	 * @param startRow Index of first row to check
+	 * @retval int Row index, -1 if not found
+	 * @note Value is looked up once, rows are then compared by identifier
+	 */
+	int find(unsigned column, const char* value, unsigned startRow = 0) const;
+
+	const StringPool& getPool() const
+	{
+		return pool;
+	}
+
+	/**
+	 * @brief Discard all rows and strings
+	 */
+	void clear()
+	{
+		ids.clear();
+		pool.clear();
+	}
+
+private:
+	StringPool pool;
+	std::vector<Id> ids;
+	unsigned columnCount;
+};
+
+} // namespace CSV
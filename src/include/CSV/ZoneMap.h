@@ -0,0 +1,187 @@
+/****
+ * ZoneMap.h
+ *
+ * Copyright 2024 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the CsvReader Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "Reader.h"
+#include <vector>
+
+namespace CSV
+{
+/**
+ * @brief Summary of value ranges for blocks of consecutive records
+ *
+ * For each block the location of its records in the source is stored, plus the minimum and
+ * maximum values of selected columns. A range scan then only reads blocks which may contain
+ * matching values, which is effective where values are clustered, such as timestamps in log files.
+ *
+ * Values are compared numerically if they are numbers, otherwise lexicographically (strcmp).
+ * Empty values are ignored.
+ *
+ * The map can be built during a normal scan of the data using `add()`, and saved for later use
+ * provided the source data does not change.
+ */
+class ZoneMap
+{
+public:
+	/**
+	 * @brief Location of a block of records
+	 */
+	struct Block {
+		int start;		///< Cursor::start of first record
+		unsigned end;	///< Cursor::end of last record
+		unsigned count; ///< Number of records
+	};
+
+	/**
+	 * @brief Value range for one column of a block
+	 */
+	struct Summary {
+		double min;		///< Numeric range, valid only if `numeric` is set
+		double max;
+		String minText; ///< Lexicographic range, null if all values are empty
+		String maxText;
+		bool numeric;	///< All non-empty values are numbers
+	};
+
+	/**
+	 * @brief Called for each matching record
+	 * @param reader Reader positioned on the record
+	 * @retval bool Return true to continue, false to stop
+	 */
+	using Callback = Delegate<bool(Reader& reader)>;
+
+	/**
+	 * @brief Start building a new map
+	 * @param columns Indices of columns to summarise
+	 * @param blockSize Number of records per block
+	 */
+	void begin(const std::vector<unsigned>& columns, unsigned blockSize = 64);
+
+	/**
+	 * @brief Add a record to the map
+	 * @param cursor Location of record
+	 * @param row Record content
+	 * @note Records must be added in source order
+	 */
+	void add(const Cursor& cursor, const CStringArray& row);
+
+	/**
+	 * @brief Complete the final block
+	 */
+	void end();
+
+	/**
+	 * @brief Build map by scanning all records
+	 * @param reader
+	 * @param columns Indices of columns to summarise
+	 * @param blockSize Number of records per block
+	 * @note On return the reader is reset
+	 */
+	void build(Reader& reader, const std::vector<unsigned>& columns, unsigned blockSize = 64);
+
+	/**
+	 * @brief Determine if a block may contain values in a given range
+	 * @param block Block index
+	 * @param column Column index, as passed to `begin()`
+	 * @param min Lowest value to match, nullptr for no lower limit
+	 * @param max Highest value to match, nullptr for no upper limit
+	 * @retval bool false if block definitely contains no matching values
+	 *
+	 * If both limits are numbers the comparison is numeric. Blocks containing non-numeric
+	 * values are then always candidates as their range cannot be determined.
+	 */
+	bool mayContain(unsigned block, unsigned column, const char* min, const char* max) const;
+
+	/**
+	 * @brief Find records with values in a given range
+	 * @param reader Reader for the mapped data
+	 * @param column Column index, as passed to `begin()`
+	 * @param min Lowest value to match, nullptr for no lower limit
+	 * @param max Highest value to match, nullptr for no upper limit
+	 * @param callback Invoked for each matching record in source order, may be nullptr
+	 * @retval unsigned Number of matches
+	 *
+	 * Each candidate block is read by seeking directly to its first record.
+	 * The callback must not move the reader.
+	 */
+	unsigned scan(Reader& reader, unsigned column, const char* min, const char* max, Callback callback) const;
+
+	/**
+	 * @brief Write map to a stream
+	 * @retval bool true on success
+	 */
+	bool save(Print& out) const;
+
+	/**
+	 * @brief Read map previously written by `save()`
+	 * @retval bool false if data is invalid, map is left empty
+	 */
+	bool load(Stream& in);
+
+	void clear()
+	{
+		blocks.clear();
+		summaries.clear();
+		current = {};
+	}
+
+	/**
+	 * @brief Get number of blocks
+	 */
+	unsigned count() const
+	{
+		return blocks.size();
+	}
+
+	const Block& operator[](unsigned index) const
+	{
+		return blocks[index];
+	}
+
+	/**
+	 * @brief Get value range for a column of a block
+	 * @retval const Summary& Empty summary if block is invalid or column is not summarised
+	 */
+	const Summary& getSummary(unsigned block, unsigned column) const
+	{
+		static const Summary empty{};
+		auto index = columnIndex(column);
+		if(block >= blocks.size() || index >= columns.size()) {
+			return empty;
+		}
+		return summaries[block * columns.size() + index];
+	}
+
+	const std::vector<unsigned>& getColumns() const
+	{
+		return columns;
+	}
+
+private:
+	unsigned columnIndex(unsigned column) const;
+
+	std::vector<unsigned> columns;
+	std::vector<Block> blocks;
+	std::vector<Summary> summaries; ///< For each block, one entry per column
+	Block current{};				///< Block being built
+	unsigned blockSize{0};
+};
+
+} // namespace CSV
@@ -0,0 +1,111 @@
+#include <SmingTest.h>
+#include <CSV/Aggregate.h>
+
+DEFINE_FSTR_LOCAL(sales_csv, "region,amount\n"
+							 "north,10\n"
+							 "south,2.5\n"
+							 "north,-3\n"
+							 "east,1e2\n"
+							 "south,n/a\n"
+							 "north,7\n")
+
+class AggregateTest : public TestGroup
+{
+public:
+	AggregateTest() : TestGroup(_F("Aggregate test"))
+	{
+	}
+
+	void execute() override
+	{
+		TEST_CASE("Number parsing")
+		{
+			double d{};
+			CHECK(CSV::parseNumber("12.5", d) && d == 12.5);
+			CHECK(CSV::parseNumber(" -0.25 ", d) && d == -0.25);
+			CHECK(CSV::parseNumber("1e3", d) && d == 1000);
+			CHECK(CSV::parseNumber("+.5E-1", d) && d == 0.05);
+			CHECK(!CSV::parseNumber("", d));
+			CHECK(!CSV::parseNumber(".", d));
+			CHECK(!CSV::parseNumber("1e", d));
+			CHECK(!CSV::parseNumber("12abc", d));
+
+			int64_t n{};
+			CHECK(CSV::parseInteger("-9223372036854775808", n) && n == INT64_MIN);
+			CHECK(CSV::parseInteger("9223372036854775807", n) && n == INT64_MAX);
+			CHECK(!CSV::parseInteger("9223372036854775808", n));
+			CHECK(!CSV::parseInteger("1.5", n));
+		}
+
+		TEST_CASE("Group by")
+		{
+			CSV::Reader reader(new FSTR::Stream(sales_csv));
+			CSV::GroupBy groups(reader.getColumn("region"), reader.getColumn("amount"));
+			CHECK_EQ(groups.run(reader), 6U);
+			CHECK(!groups.hasError());
+			CHECK_EQ(groups.count(), 3U);
+
+			auto north = groups.find("north");
+			REQUIRE(north != nullptr);
+			CHECK_EQ(north->stats.count, 3U);
+			CHECK_EQ(north->stats.sum, 14.0);
+			CHECK_EQ(north->stats.min, -3.0);
+			CHECK_EQ(north->stats.max, 10.0);
+
+			auto south = groups.find("south");
+			REQUIRE(south != nullptr);
+			CHECK_EQ(south->stats.count, 2U);
+			CHECK_EQ(south->stats.valueCount, 1U);
+			CHECK(groups.find("west") == nullptr);
+
+			auto top = groups.top(2, CSV::GroupBy::Order::sum);
+			REQUIRE_EQ(top.size(), 2U);
+			CHECK(F("east") == top[0]->key);
+			CHECK(F("north") == top[1]->key);
+
+			CSV::GroupBy total(reader.getColumn("region"), reader.getColumn("amount"));
+			CHECK(total.merge(groups));
+			CHECK(total.merge(groups));
+			CHECK_EQ(total.find("north")->stats.count, 6U);
+			CHECK_EQ(total.find("east")->stats.sum, 200.0);
+		}
+
+		TEST_CASE("Key too long")
+		{
+			CSV::GroupBy groups(0);
+			String key;
+			REQUIRE(key.setLength(UINT16_MAX + 1));
+			memset(key.begin(), 'k', key.length());
+			CStringArray row;
+			row.add(key);
+			CHECK(!groups.add(row));
+			CHECK(groups.hasError());
+			CHECK_EQ(groups.count(), 0U);
+			groups.clear();
+			CHECK(!groups.hasError());
+		}
+
+		TEST_CASE("Count per country code")
+		{
+			CSV::Reader reader(new FileStream(F("zone1970.tab")), CSV::Parser::Options{
+																	  .commentChars = "#",
+																	  .fieldSeparator = '\t',
+																  });
+			CSV::GroupBy groups(0);
+			auto recordCount = groups.run(reader);
+			for(auto group : groups.top(5)) {
+				Serial << "  " << group->key << ": " << group->stats.count << endl;
+			}
+			unsigned total{0};
+			for(unsigned i = 0; i < groups.count(); ++i) {
+				total += groups[i].stats.count;
+			}
+			CHECK_EQ(total, recordCount);
+		}
+	}
+};
+
+void REGISTER_TEST(aggregate)
+{
+	registerGroup<AggregateTest>();
+}
@@ -0,0 +1,145 @@
+#include <SmingTest.h>
+#include <CSV/AsyncParser.h>
+#include <vector>
+
+// Requires coroutine support, and pipes for the test source
+#if defined(ARCH_HOST) && defined(__cpp_impl_coroutine) && !defined(__WIN32)
+#define ASYNC_TEST 1
+#else
+#define ASYNC_TEST 0
+#endif
+
+#if ASYNC_TEST
+
+#include <thread>
+#include <unistd.h>
+
+namespace
+{
+using Rows = std::vector<String>;
+
+String createInput()
+{
+	String s;
+	s += "id,name\n";
+	for(unsigned i = 0; i < 500; ++i) {
+		s += i;
+		s += ",\"Record\n";
+		s += i;
+		s += "\"\n";
+	}
+	s += "500,last";
+	return s;
+}
+
+CSV::AsyncTask collect(CSV::AsyncParser& parser, Rows& rows)
+{
+	while(auto row = co_await parser.next()) {
+		rows.push_back(row->join(";"));
+	}
+}
+
+} // namespace
+
+class AsyncTest : public TestGroup
+{
+public:
+	AsyncTest() : TestGroup(_F("Async parser"))
+	{
+	}
+
+	void execute() override
+	{
+		const String input = createInput();
+
+		Rows expected;
+		{
+			CSV::Parser parser(CSV::Parser::Options{});
+			size_t offset{0};
+			while(parser.push(input.c_str(), input.length(), offset)) {
+				expected.push_back(parser.getRow().join(";"));
+			}
+			while(parser.flush()) {
+				expected.push_back(parser.getRow().join(";"));
+			}
+		}
+		REQUIRE_EQ(expected.size(), 502U);
+
+		TEST_CASE("Chunked writes")
+		{
+			for(size_t chunkSize : {1, 7, 100, 5000}) {
+				Rows rows;
+				CSV::AsyncParser parser(CSV::Parser::Options{});
+				auto task = collect(parser, rows);
+				CHECK(parser.isWaiting());
+				for(size_t pos = 0; pos < input.length(); pos += chunkSize) {
+					parser.write(input.c_str() + pos, std::min(chunkSize, input.length() - pos));
+					CHECK(parser.isWaiting());
+				}
+				CHECK(!task.done());
+				parser.end();
+				CHECK(task.done());
+				CHECK(!parser.isWaiting());
+				CHECK(rows == expected);
+			}
+		}
+
+		TEST_CASE("Write before consumer starts")
+		{
+			Rows rows;
+			CSV::AsyncParser parser(CSV::Parser::Options{});
+			auto len = input.length() / 2;
+			parser.write(input.c_str(), len);
+			auto task = collect(parser, rows);
+			CHECK(!rows.empty());
+			parser.write(input.c_str() + len, input.length() - len);
+			parser.end();
+			CHECK(task.done());
+			CHECK(rows == expected);
+		}
+
+		TEST_CASE("Pipe source")
+		{
+			int fds[2];
+			REQUIRE(pipe(fds) == 0);
+			// Test macros are not thread-safe so check result after join
+			bool writeOk{true};
+			std::thread writer([&]() {
+				// Irregular chunk sizes
+				for(size_t pos = 0, len = 1; pos < input.length(); pos += len, len = 1 + (len * 7) % 300) {
+					len = std::min(len, input.length() - pos);
+					if(::write(fds[1], input.c_str() + pos, len) != ssize_t(len)) {
+						writeOk = false;
+						break;
+					}
+				}
+				close(fds[1]);
+			});
+
+			Rows rows;
+			CSV::AsyncParser parser(CSV::Parser::Options{});
+			auto task = collect(parser, rows);
+			char buffer[128];
+			ssize_t len;
+			while((len = read(fds[0], buffer, sizeof(buffer))) > 0) {
+				parser.write(buffer, len);
+			}
+			parser.end();
+			writer.join();
+			close(fds[0]);
+			CHECK(writeOk);
+
+			CHECK(task.done());
+			CHECK(rows == expected);
+		}
+	}
+};
+
+#endif // ASYNC_TEST
+
+void REGISTER_TEST(async)
+{
+#if ASYNC_TEST
+	registerGroup<AsyncTest>();
+#endif
+}
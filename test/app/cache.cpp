@@ -0,0 +1,175 @@
+#include <SmingTest.h>
+#include <CSV/Reader.h>
+#include <CSV/CachedStream.h>
+#include <WVector.h>
+
+namespace
+{
+/*
+ * Memory stream which counts data read and repositioning
+ */
+class CountingStream : public MemoryDataStream
+{
+public:
+	size_t readBytes(char* buffer, size_t length) override
+	{
+		auto len = MemoryDataStream::readBytes(buffer, length);
+		readCount += len;
+		return len;
+	}
+
+	int seekFrom(int offset, SeekOrigin origin) override
+	{
+		if(origin != SeekOrigin::Current) {
+			++seekCount;
+		}
+		return MemoryDataStream::seekFrom(offset, origin);
+	}
+
+	size_t readCount{0};
+	unsigned seekCount{0};
+};
+
+CountingStream* createStream()
+{
+	auto stream = new CountingStream;
+	stream->print("id,name\r\n");
+	for(unsigned i = 0; i < 200; ++i) {
+		stream->print(i);
+		stream->print(",\"Record ");
+		stream->print(i);
+		stream->print("\"\r\n");
+	}
+	return stream;
+}
+
+} // namespace
+
+class CacheTest : public TestGroup
+{
+public:
+	CacheTest() : TestGroup(_F("Cache test"))
+	{
+	}
+
+	void execute() override
+	{
+		Vector<CSV::Cursor> cursors;
+		{
+			CSV::Reader reader(createStream(), CSV::Parser::Options{});
+			while(reader.next()) {
+				cursors.add(reader.getCursor());
+			}
+		}
+		REQUIRE_EQ(cursors.count(), 200U);
+
+		TEST_CASE("Seek within buffer")
+		{
+			auto stream = createStream();
+			CSV::Reader reader(stream, CSV::Parser::Options{});
+			REQUIRE(reader.next());
+			// Skip alternate records: these are already buffered so source is read only once
+			auto seeks = stream->seekCount;
+			for(unsigned i = 2; i < cursors.count(); i += 2) {
+				REQUIRE(reader.seek(cursors[i]));
+				CHECK_EQ(reader.tell(), cursors[i].start);
+				CHECK_EQ(atoi(reader.getValue("id")), int(i));
+			}
+			CHECK_EQ(stream->seekCount, seeks);
+			CHECK_EQ(stream->readCount, stream->getSize());
+
+			// Seeking backwards must re-read
+			REQUIRE(reader.seek(cursors[10]));
+			CHECK_EQ(atoi(reader.getValue("id")), 10);
+			CHECK(stream->seekCount > seeks);
+		}
+
+		TEST_CASE("Cached stream")
+		{
+			auto stream = createStream();
+			auto cache = new CSV::CachedStream(stream, 4, 512);
+			CSV::Reader reader(cache, CSV::Parser::Options{});
+			REQUIRE(reader.seek(cursors[100]));
+			auto reads = stream->readCount;
+			auto misses = cache->getMissCount();
+			// Alternate between nearby records
+			for(unsigned n = 0; n < 20; ++n) {
+				REQUIRE(reader.prev());
+				CHECK_EQ(atoi(reader.getValue("id")), 99);
+				REQUIRE(reader.next());
+				CHECK_EQ(atoi(reader.getValue("id")), 100);
+			}
+			Serial << _F("Cache hits ") << cache->getHitCount() << _F(", misses ") << cache->getMissCount() << endl;
+			CHECK(cache->getMissCount() - misses <= 2);
+			CHECK(stream->readCount - reads <= 2 * 512);
+
+			// Read everything through the cache
+			reader.reset();
+			unsigned count{0};
+			while(reader.next()) {
+				CHECK_EQ(reader.tell(), cursors[count].start);
+				++count;
+			}
+			CHECK_EQ(count, cursors.count());
+			CHECK(reader.last());
+			CHECK_EQ(atoi(reader.getValue("id")), 199);
+		}
+
+		TEST_CASE("Record cache")
+		{
+			auto stream = createStream();
+			CSV::Reader reader(stream, CSV::Parser::Options{});
+			reader.setCacheSize(256);
+			auto cache = reader.getCache();
+			REQUIRE(cache != nullptr);
+
+			// Repeated lookups of a few hot records
+			const unsigned hot[]{150, 20, 75};
+			for(unsigned n = 0; n < 10; ++n) {
+				for(auto i : hot) {
+					REQUIRE(reader.seek(cursors[i]));
+					CHECK_EQ(atoi(reader.getValue("id")), int(i));
+					CHECK_EQ(reader.tell(), cursors[i].start);
+				}
+			}
+			Serial << _F("Record cache hits ") << cache->getHitCount() << _F(", misses ") << cache->getMissCount()
+				   << _F(", ") << cache->getUsed() << _F(" bytes used") << endl;
+			CHECK_EQ(cache->getMissCount(), 3U);
+			CHECK_EQ(cache->getHitCount(), 27U);
+			CHECK(cache->getUsed() <= cache->getCapacity());
+
+			// Reading continues correctly from a cached record
+			REQUIRE(reader.seek(cursors[20]));
+			CHECK_EQ(cache->getHitCount(), 28U);
+			REQUIRE(reader.next());
+			CHECK_EQ(atoi(reader.getValue("id")), 21);
+			CHECK_EQ(reader.tell(), cursors[21].start);
+
+			// Seeking backwards does not use the cache
+			auto cachedCount = cache->count();
+			REQUIRE(reader.prev());
+			CHECK_EQ(atoi(reader.getValue("id")), 20);
+			REQUIRE(reader.last());
+			CHECK_EQ(cache->getHitCount(), 28U);
+			CHECK_EQ(cache->getMissCount(), 3U);
+			CHECK_EQ(cache->count(), cachedCount);
+
+			// Budget is enforced, least-recently used records discarded first
+			for(unsigned i = 100; i < 120; ++i) {
+				REQUIRE(reader.seek(cursors[i]));
+			}
+			CHECK(cache->getUsed() <= cache->getCapacity());
+			CHECK(cache->count() < 20);
+			auto misses = cache->getMissCount();
+			REQUIRE(reader.seek(cursors[119]));
+			CHECK_EQ(cache->getMissCount(), misses);
+			REQUIRE(reader.seek(cursors[150]));
+			CHECK_EQ(cache->getMissCount(), misses + 1);
+		}
+	}
+};
+
+void REGISTER_TEST(cache)
+{
+	registerGroup<CacheTest>();
+}
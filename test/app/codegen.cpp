@@ -0,0 +1,87 @@
+#include <SmingTest.h>
+#include <CSV/CodeGenerator.h>
+#include "../files/stock.h"
+
+IMPORT_FSTR_LOCAL(stock_h, PROJECT_DIR "/files/stock.h")
+
+// Generated tables are usable at compile time
+static_assert(Test::Stock::recordCount == 4);
+static_assert(Test::Stock::findByName("Sprocket")->stock == 1234);
+static_assert(Test::Stock::findById(2)->price == 12.0);
+static_assert(Test::Stock::findByBarcode("9780201379624")->id == 4);
+static_assert(Test::Stock::findById(5) == nullptr);
+
+class CodeGeneratorTest : public TestGroup
+{
+public:
+	CodeGeneratorTest() : TestGroup(_F("Code generator test"))
+	{
+	}
+
+	void execute() override
+	{
+		using ValueType = CSV::ValueType;
+
+		TEST_CASE("Identifiers")
+		{
+			CHECK(CSV::CodeGenerator::makeIdentifier("TZ") == "TZ");
+			CHECK(CSV::CodeGenerator::makeIdentifier("first name") == "first_name");
+			CHECK(CSV::CodeGenerator::makeIdentifier("1") == "_1");
+			CHECK(CSV::CodeGenerator::makeIdentifier("class") == "class_");
+			CHECK(CSV::CodeGenerator::makeIdentifier("int") == "int_");
+			CHECK(CSV::CodeGenerator::makeIdentifier("integer") == "integer");
+		}
+
+		TEST_CASE("Unique identifiers")
+		{
+			auto source = new MemoryDataStream;
+			source->print("first name,first-name,first name_2,default,Name,name\n"
+						  "a,b,c,d,e,f\n");
+			CSV::Reader reader(source, CSV::Parser::Options{});
+			CSV::CodeGenerator generator(reader);
+			MemoryDataStream out;
+			REQUIRE(generator.generate(out, "Test"));
+			String content = out.readString(out.available());
+			CHECK(content.indexOf("\tconst char* first_name;\n") > 0);
+			CHECK(content.indexOf("\tconst char* first_name_2;\n") > 0);
+			CHECK(content.indexOf("\tconst char* first_name_2_2;\n") > 0);
+			CHECK(content.indexOf("\tconst char* default_;\n") > 0);
+			CHECK(content.indexOf("\tconst char* Name;\n") > 0);
+			CHECK(content.indexOf("\tconst char* name_2;\n") > 0);
+			// Each lookup function is defined once
+			int pos = content.indexOf("findByName(");
+			CHECK(pos > 0);
+			CHECK(content.indexOf("findByName(", pos + 1) < 0);
+		}
+
+		TEST_CASE("Generate header")
+		{
+			CSV::Reader reader(new FileStream(F("stock.csv")), CSV::Parser::Options{});
+			REQUIRE(reader);
+			// Barcodes have leading zeroes so must be text
+			CSV::CodeGenerator generator(reader, {ValueType::empty, ValueType::empty, ValueType::empty,
+												  ValueType::empty, ValueType::text});
+			MemoryDataStream out;
+			REQUIRE(generator.generate(out, "Test::Stock"));
+			String content = out.readString(out.available());
+			REQUIRE_EQ(content.length(), stock_h.length());
+			CHECK(stock_h == content);
+
+			CHECK(!generator.generate(out, "Test::"));
+			CHECK(!generator.generate(out, "3D"));
+		}
+
+		TEST_CASE("Type mismatch")
+		{
+			CSV::Reader reader(new FileStream(F("stock.csv")), CSV::Parser::Options{});
+			CSV::CodeGenerator generator(reader, {ValueType::empty, ValueType::integer});
+			MemoryDataStream out;
+			CHECK(!generator.generate(out, "Test"));
+		}
+	}
+};
+
+void REGISTER_TEST(codegen)
+{
+	registerGroup<CodeGeneratorTest>();
+}
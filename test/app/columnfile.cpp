@@ -0,0 +1,218 @@
+#include <SmingTest.h>
+#include <CSV/ColumnFile.h>
+#include <Data/Stream/MemoryDataStream.h>
+#include <vector>
+
+#if defined(ARCH_HOST) && !defined(__WIN32)
+#define MAPPED_FILE_TEST
+#include <CSV/MappedFile.h>
+#include <IFS/Host/FileSystem.h>
+#endif
+
+namespace
+{
+using Encoding = CSV::ColumnFile::Encoding;
+
+#ifdef MAPPED_FILE_TEST
+DEFINE_FSTR_LOCAL(tableFile, "out/columns.bin")
+#endif
+
+enum Column {
+	col_id,
+	col_price,
+	col_category,
+	col_name,
+	col_blank,
+	col_code,
+};
+
+IDataSourceStream* createData(unsigned count)
+{
+	auto stream = new MemoryDataStream;
+	stream->print("id,price,category,name,blank,code\n");
+	for(unsigned i = 0; i < count; ++i) {
+		stream->print(i);
+		stream->print(',');
+		if(i % 7 != 3) {
+			stream->print(i);
+			stream->print(".5");
+		}
+		stream->print(",cat");
+		stream->print(i % 5);
+		stream->print(",\"Name ");
+		stream->print(i);
+		stream->print("\",,C");
+		stream->print((i * 13) % 300);
+		stream->print('\n');
+	}
+	return stream;
+}
+
+/*
+ * Table data must be 8-byte aligned
+ */
+std::vector<uint64_t> buildTable(CSV::Reader& reader, const CSV::ColumnFile::Settings& settings)
+{
+	MemoryDataStream out;
+	if(!CSV::ColumnFile::build(reader, out, settings)) {
+		return {};
+	}
+	String s;
+	out.moveString(s);
+	std::vector<uint64_t> data((s.length() + 7) / 8);
+	memcpy(data.data(), s.c_str(), s.length());
+	data.resize(s.length() / 8);
+	return data;
+}
+
+} // namespace
+
+class ColumnFileTest : public TestGroup
+{
+public:
+	ColumnFileTest() : TestGroup(_F("Column file"))
+	{
+	}
+
+	void execute() override
+	{
+		const unsigned count{1000};
+		CSV::Reader reader(createData(count));
+		auto data = buildTable(reader, {.chunkRecords = 400});
+		REQUIRE(!data.empty());
+		Serial << _F("Table for ") << count << _F(" records is ") << data.size() * 8 << _F(" bytes") << endl;
+
+		CSV::ColumnFile table(data.data(), data.size() * 8);
+		REQUIRE(table);
+
+		TEST_CASE("Structure")
+		{
+			CHECK_EQ(table.count(), count);
+			REQUIRE_EQ(table.getColumnCount(), 6U);
+			CHECK_EQ(table.getChunkCount(), 3U);
+			CHECK_EQ(table.getChunkStart(1), 400U);
+			CHECK_EQ(table.getChunkStart(3), count);
+			CHECK(F("category") == table.getHeading(col_category));
+			CHECK_EQ(table.getColumn("code"), col_code);
+			CHECK_EQ(table.getColumn("missing"), -1);
+			CHECK(table.getHeading(6) == nullptr);
+
+			CHECK_EQ(table.getType(col_id), CSV::ValueType::integer);
+			CHECK_EQ(table.getType(col_price), CSV::ValueType::number);
+			CHECK_EQ(table.getType(col_category), CSV::ValueType::text);
+			CHECK_EQ(table.getType(col_blank), CSV::ValueType::empty);
+
+			auto chunk = table.getChunk(0, col_id);
+			CHECK_EQ(chunk.getEncoding(), Encoding::integer);
+			CHECK_EQ(table.getChunk(0, col_price).getEncoding(), Encoding::number);
+			CHECK_EQ(table.getChunk(0, col_category).getEncoding(), Encoding::dictionary8);
+			CHECK_EQ(table.getChunk(0, col_category).getDictionarySize(), 5U);
+			CHECK_EQ(table.getChunk(0, col_name).getEncoding(), Encoding::text);
+			CHECK_EQ(table.getChunk(0, col_blank).getEncoding(), Encoding::empty);
+			CHECK_EQ(table.getChunk(0, col_code).getEncoding(), Encoding::dictionary16);
+			CHECK(!table.getChunk(3, 0));
+			CHECK(!table.getChunk(0, 6));
+		}
+
+		TEST_CASE("Values")
+		{
+			reader.reset();
+			unsigned mismatches{0};
+			unsigned record{0};
+			for(unsigned c = 0; c < table.getChunkCount(); ++c) {
+				auto id = table.getChunk(c, col_id);
+				auto price = table.getChunk(c, col_price);
+				auto category = table.getChunk(c, col_category);
+				auto name = table.getChunk(c, col_name);
+				auto blank = table.getChunk(c, col_blank);
+				auto code = table.getChunk(c, col_code);
+				for(unsigned i = 0; i < id.count(); ++i, ++record) {
+					REQUIRE(reader.next());
+					double n{0};
+					bool hasPrice = CSV::parseNumber(reader.getValue(col_price), n);
+					if(id.getIntegers()[i] != int64_t(record) || price.isEmpty(i) == hasPrice ||
+					   price.getNumber(i) != n || strcmp(category.getText(i), reader.getValue(col_category)) != 0 ||
+					   strcmp(name.getText(i), reader.getValue(col_name)) != 0 || !blank.isEmpty(i) ||
+					   strcmp(code.getText(i), reader.getValue(col_code)) != 0) {
+						++mismatches;
+					}
+				}
+			}
+			CHECK_EQ(record, count);
+			CHECK(!reader.next());
+			CHECK_EQ(mismatches, 0U);
+
+			auto price = table.getChunk(0, col_price);
+			CHECK(price.isEmpty(3));
+			CHECK_EQ(price.getInteger(4), 4);
+			CHECK(price.getText(0) == nullptr);
+			auto category = table.getChunk(1, col_category);
+			CHECK(F("cat2") == category.getDictionaryValue(category.getCode(2)));
+		}
+
+		TEST_CASE("Settings")
+		{
+			// Plain text only, chunks limited by size
+			reader.reset();
+			auto plain = buildTable(reader, {.chunkSize = 4096, .dictionary = false});
+			CSV::ColumnFile table(plain.data(), plain.size() * 8);
+			REQUIRE(table);
+			CHECK_EQ(table.count(), count);
+			CHECK(table.getChunkCount() > 3);
+			CHECK(table.getChunkStart(1) < 400);
+			CHECK_EQ(table.getChunk(0, col_category).getEncoding(), Encoding::text);
+			CHECK(plain.size() > data.size());
+		}
+
+		TEST_CASE("Invalid data")
+		{
+			CHECK(!CSV::ColumnFile(data.data(), data.size() * 8 - 8));
+			CHECK(!CSV::ColumnFile(reinterpret_cast<uint8_t*>(data.data()) + 4, data.size() * 8 - 8));
+			CHECK(!CSV::ColumnFile(nullptr, 0));
+
+			auto copy = data;
+			copy[0] = 0;
+			CHECK(!CSV::ColumnFile(copy.data(), copy.size() * 8));
+
+			// Footer offset beyond trailer
+			copy = data;
+			auto trailer = reinterpret_cast<CSV::ColumnFile::Trailer*>(&copy.back() - 1);
+			trailer->footerOffset = 0xfffffff8;
+			CHECK(!CSV::ColumnFile(copy.data(), copy.size() * 8));
+			trailer->footerOffset = copy.size() * 8;
+			CHECK(!CSV::ColumnFile(copy.data(), copy.size() * 8));
+		}
+
+#ifdef MAPPED_FILE_TEST
+		TEST_CASE("Memory-mapped file")
+		{
+			auto& fs = IFS::Host::getFileSystem();
+			{
+				FileStream file(&fs);
+				REQUIRE(file.open(tableFile, File::CreateNewAlways | File::WriteOnly));
+				size_t size = data.size() * 8;
+				REQUIRE_EQ(file.write(reinterpret_cast<const uint8_t*>(data.data()), size), size);
+			}
+
+			{
+				CSV::MappedFile map(String(tableFile).c_str());
+				REQUIRE(map);
+				CHECK_EQ(map.getLength(), data.size() * 8);
+				CSV::ColumnFile mapped(map.getData(), map.getLength());
+				REQUIRE(mapped);
+				CHECK_EQ(mapped.count(), count);
+				auto name = mapped.getChunk(2, col_name);
+				CHECK(F("Name 999") == name.getText(name.count() - 1));
+			}
+
+			CHECK(!CSV::MappedFile("out/missing.bin"));
+			fs.remove(String(tableFile).c_str());
+		}
+#endif
+	}
+};
+
+void REGISTER_TEST(columnfile)
+{
+	registerGroup<ColumnFileTest>();
+}
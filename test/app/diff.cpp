@@ -0,0 +1,148 @@
+#include <SmingTest.h>
+#include <CSV/Diff.h>
+#include <CSV/Hash.h>
+#include <Data/Stream/MemoryDataStream.h>
+#include <vector>
+
+namespace
+{
+using Options = CSV::Parser::Options;
+
+constexpr Options hashOptions{.hashFields = true};
+
+/*
+ * Records with id 0 to 99, optionally modified
+ */
+IDataSourceStream* createData(bool modified)
+{
+	auto stream = new MemoryDataStream;
+	stream->print("id,name,value\n");
+	for(unsigned i = 0; i < 100; ++i) {
+		if(modified && i == 10) {
+			// Removed
+			continue;
+		}
+		stream->print(i);
+		if(modified && i == 30) {
+			// Same content, different quoting and line ending
+			stream->print(",\"Item 30\",\"60\"\r\n");
+			continue;
+		}
+		stream->print(",Item ");
+		stream->print(i);
+		stream->print(',');
+		stream->print((modified && i == 20) ? 999 : i * 2);
+		stream->print('\n');
+	}
+	if(modified) {
+		stream->print("200,Item 200,400\n");
+	}
+	return stream;
+}
+
+} // namespace
+
+class DiffTest : public TestGroup
+{
+public:
+	DiffTest() : TestGroup(_F("Diff test"))
+	{
+	}
+
+	void execute() override
+	{
+		TEST_CASE("xxh32")
+		{
+			CHECK_EQ(CSV::xxh32("", 0), 0x02CC5D05U);
+			CHECK_EQ(CSV::xxh32("abc", 3), 0x32D153FFU);
+			CHECK_EQ(CSV::xxh32("abc", 3, 1), 0xAA3DA8FFU);
+			const char* text = "Nobody inspects the spammish repetition";
+			CHECK_EQ(CSV::xxh32(text, strlen(text)), 0xE2293B2FU);
+		}
+
+		TEST_CASE("Record hashes")
+		{
+			String data = "a,\"b\",c\n"
+						  "a,b,c\r\n"
+						  "a,b,d\n";
+			CSV::Parser parser(hashOptions);
+			size_t offset{0};
+			std::vector<uint32_t> hashes;
+			while(parser.push(data.c_str(), data.length(), offset)) {
+				hashes.push_back(parser.getHash());
+				CHECK_EQ(parser.getFieldHash(1), CSV::xxh32("b", 1));
+				CHECK_EQ(parser.getFieldHash(3), 0U);
+			}
+			while(parser.flush()) {
+				hashes.push_back(parser.getHash());
+			}
+			REQUIRE_EQ(hashes.size(), 3U);
+			CHECK_EQ(hashes[0], hashes[1]);
+			CHECK(hashes[1] != hashes[2]);
+
+			CSV::Parser plain(Options{});
+			offset = 0;
+			REQUIRE(plain.push(data.c_str(), data.length(), offset));
+			CHECK_EQ(plain.getHash(), 0U);
+		}
+
+		TEST_CASE("Diff with key")
+		{
+			CSV::Reader oldReader(createData(false), hashOptions);
+			CSV::Reader newReader(createData(true), hashOptions);
+			std::vector<CSV::Diff::Change> changes;
+			std::vector<String> ids;
+			CSV::Diff diff(0);
+			REQUIRE(diff.compare(oldReader, newReader, [&](const CSV::Diff::Change& change) {
+				changes.push_back(change);
+				ids.push_back((change.kind == CSV::Diff::Kind::removed) ? nullptr : newReader.getValue("id"));
+			}));
+			auto& summary = diff.getSummary();
+			CHECK_EQ(summary.unchanged, 98U);
+			CHECK_EQ(summary.inserted, 1U);
+			CHECK_EQ(summary.removed, 1U);
+			CHECK_EQ(summary.changed, 1U);
+			REQUIRE_EQ(changes.size(), 3U);
+
+			CHECK(changes[0].kind == CSV::Diff::Kind::changed);
+			CHECK(ids[0] == "20");
+			REQUIRE(oldReader.seek(changes[0].oldRecord));
+			CHECK_EQ(String(oldReader.getValue("value")), "40");
+
+			CHECK(changes[1].kind == CSV::Diff::Kind::inserted);
+			CHECK(ids[1] == "200");
+			CHECK_EQ(changes[1].oldRecord, CSV::Parser::BOF);
+
+			CHECK(changes[2].kind == CSV::Diff::Kind::removed);
+			CHECK_EQ(changes[2].newRecord, CSV::Parser::BOF);
+			REQUIRE(oldReader.seek(changes[2].oldRecord));
+			CHECK_EQ(String(oldReader.getValue("id")), "10");
+		}
+
+		TEST_CASE("Diff by content")
+		{
+			CSV::Reader oldReader(createData(false), hashOptions);
+			CSV::Reader newReader(createData(true), hashOptions);
+			CSV::Diff diff;
+			REQUIRE(diff.compare(oldReader, newReader, nullptr));
+			auto& summary = diff.getSummary();
+			CHECK_EQ(summary.unchanged, 98U);
+			CHECK_EQ(summary.inserted, 2U);
+			CHECK_EQ(summary.removed, 2U);
+			CHECK_EQ(summary.changed, 0U);
+		}
+
+		TEST_CASE("Hashing required")
+		{
+			CSV::Reader oldReader(createData(false));
+			CSV::Reader newReader(createData(true), hashOptions);
+			CSV::Diff diff(0);
+			CHECK(!diff.compare(oldReader, newReader, nullptr));
+		}
+	}
+};
+
+void REGISTER_TEST(diff)
+{
+	registerGroup<DiffTest>();
+}
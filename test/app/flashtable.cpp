@@ -0,0 +1,89 @@
+#include <SmingTest.h>
+#include <CSV/FlashTable.h>
+
+// 0: Normal
+// 1: Generate table file (host only)
+#define GENERATE_TABLE_FILE 0
+
+#if GENERATE_TABLE_FILE
+#include <IFS/Host/FileSystem.h>
+#else
+IMPORT_FSTR_LOCAL(zone1970_table, PROJECT_DIR "/files/zone1970.tab.table")
+#endif
+
+class FlashTableTest : public TestGroup
+{
+public:
+	FlashTableTest() : TestGroup(_F("Flash table test"))
+	{
+	}
+
+	void execute() override
+	{
+		CStringArray headings;
+		headings.add("codes");
+		headings.add("coordinates");
+		headings.add("TZ");
+		headings.add("comments");
+		CSV::Reader reader(new FileStream(F("zone1970.tab")),
+						   CSV::Parser::Options{
+							   .commentChars = "#",
+							   .fieldSeparator = '\t',
+						   },
+						   headings);
+		REQUIRE(reader);
+
+#if GENERATE_TABLE_FILE
+		auto& fs = IFS::Host::getFileSystem();
+		IFS::File out(&fs);
+		REQUIRE(out.open(F("files/zone1970.tab.table"), File::CreateNewAlways | File::WriteOnly));
+		REQUIRE(CSV::FlashTable::build(reader, out));
+#else
+		CSV::FlashTable table(zone1970_table);
+		REQUIRE(table);
+		Serial << _F("Table has ") << table.count() << _F(" records, ") << table.getColumnCount() << _F(" columns")
+			   << endl;
+		CHECK_EQ(table.getColumnCount(), 4U);
+		CHECK_EQ(table.getColumn("TZ"), 2);
+		CHECK(F("coordinates") == table.getHeading(1));
+
+		TEST_CASE("Compare with reader")
+		{
+			unsigned record{0};
+			unsigned mismatches{0};
+			while(reader.next()) {
+				auto& row = reader.getRow();
+				for(unsigned col = 0; col < 4; ++col) {
+					if(table.getValue(record, col) != (row[col] ?: "")) {
+						++mismatches;
+					}
+				}
+				++record;
+			}
+			CHECK_EQ(record, table.count());
+			CHECK_EQ(mismatches, 0U);
+		}
+
+		TEST_CASE("Lookup")
+		{
+			int record = table.find(2, "Europe/London");
+			REQUIRE(record >= 0);
+			char buffer[16];
+			CHECK_EQ(table.read(record, 0, buffer, sizeof(buffer)), 11);
+			CHECK(strcmp(buffer, "GB,GG,IM,JE") == 0);
+			CHECK_EQ(table.read(record, 0, buffer, 4), 11);
+			CHECK(strcmp(buffer, "GB,") == 0);
+			auto row = table.getRow(record);
+			CHECK_EQ(row.count(), 4U);
+			CHECK(F("Europe/London") == row[2]);
+			CHECK_EQ(table.find(2, "Europe/Atlantis"), -1);
+			CHECK_EQ(table.getLength(table.count(), 0), -1);
+		}
+#endif
+	}
+};
+
+void REGISTER_TEST(flashtable)
+{
+	registerGroup<FlashTableTest>();
+}
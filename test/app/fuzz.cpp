@@ -0,0 +1,249 @@
+#include <SmingTest.h>
+#include <CSV/Parser.h>
+#include <Data/Stream/LimitedMemoryStream.h>
+#include <vector>
+
+// 0: Normal
+// 1: Run as libFuzzer target (host only, see component.mk)
+#ifndef CSV_FUZZ
+#define CSV_FUZZ 0
+#endif
+
+using Options = CSV::Parser::Options;
+
+namespace
+{
+/*
+ * Deterministic generator so failures can be reproduced from the seed
+ */
+class Random
+{
+public:
+	Random(uint32_t seed) : state(seed ?: 1)
+	{
+	}
+
+	uint32_t next()
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+
+	unsigned operator()(unsigned limit)
+	{
+		return next() % limit;
+	}
+
+private:
+	uint32_t state;
+};
+
+struct Record {
+	String row;
+	CSV::Cursor cursor;
+
+	bool operator==(const Record& other) const
+	{
+		return row == other.row && cursor.start == other.cursor.start && cursor.end == other.cursor.end;
+	}
+};
+
+using Records = std::vector<Record>;
+
+void addRecord(const CSV::Parser& parser, Records& records)
+{
+	auto& row = parser.getRow();
+	records.push_back({String(row.c_str(), row.length()), parser.getCursor()});
+}
+
+/*
+ * Reference: pull entire input via readRow()
+ */
+void parsePull(const String& input, const Options& options, Records& records)
+{
+	CSV::Parser parser(options);
+	LimitedMemoryStream stream(const_cast<char*>(input.c_str()), input.length(), input.length(), false);
+	while(parser.readRow(stream)) {
+		addRecord(parser, records);
+	}
+}
+
+/*
+ * Push buffer in chunks of random size
+ */
+void parsePushBuffer(const String& input, const Options& options, Random& random, Records& records)
+{
+	CSV::Parser parser(options);
+	for(size_t pos = 0; pos < input.length();) {
+		auto len = std::min(size_t(1 + random(64)), input.length() - pos);
+		size_t offset{0};
+		while(parser.push(input.c_str() + pos, len, offset)) {
+			addRecord(parser, records);
+		}
+		pos += len;
+	}
+	while(parser.flush()) {
+		addRecord(parser, records);
+	}
+}
+
+/*
+ * Push data via Stream interface in chunks of random size
+ */
+void parsePushStream(const String& input, const Options& options, Random& random, Records& records)
+{
+	CSV::Parser parser(options);
+	for(size_t pos = 0; pos < input.length();) {
+		auto len = std::min(size_t(1 + random(300)), input.length() - pos);
+		LimitedMemoryStream stream(const_cast<char*>(input.c_str()) + pos, len, len, false);
+		while(parser.push(stream)) {
+			addRecord(parser, records);
+		}
+		pos += len;
+	}
+	while(parser.flush()) {
+		addRecord(parser, records);
+	}
+}
+
+unsigned compare(const char* method, const Records& expected, const Records& actual)
+{
+	if(actual == expected) {
+		return 0;
+	}
+	Serial << method << _F(": got ") << actual.size() << _F(" records, expected ") << expected.size() << endl;
+	for(unsigned i = 0; i < std::max(actual.size(), expected.size()); ++i) {
+		if(i < actual.size() && i < expected.size() && actual[i] == expected[i]) {
+			continue;
+		}
+		Serial << _F("  First mismatch at record #") << i << endl;
+		if(i < expected.size()) {
+			Serial << _F("  Expected ") << expected[i].cursor << endl;
+			m_printHex("  ", expected[i].row.c_str(), expected[i].row.length());
+		}
+		if(i < actual.size()) {
+			Serial << _F("  Actual ") << actual[i].cursor << endl;
+			m_printHex("  ", actual[i].row.c_str(), actual[i].row.length());
+		}
+		break;
+	}
+	return 1;
+}
+
+/*
+ * Select parser options from a random value
+ */
+Options getOptions(uint32_t selector)
+{
+	static constexpr char separators[]{',', '\t', ';', '\0'};
+	static constexpr uint16_t lineLengths[]{256, 64, 32};
+	Options options;
+	options.fieldSeparator = separators[selector & 0x03];
+	options.commentChars = (selector & 0x04) ? "#" : nullptr;
+	options.parseEscape = selector & 0x08;
+	options.wantComments = selector & 0x10;
+	options.quoteChar = (selector & 0x20) ? '\'' : '"';
+	options.lineLength = lineLengths[((selector >> 6) & 0x03) % 3];
+	return options;
+}
+
+} // namespace
+
+/**
+ * @brief Parse input using all available methods and compare the results
+ * @param input Data to parse
+ * @param selector Selects options and chunking
+ * @retval unsigned Number of methods giving results which differ from readRow()
+ */
+unsigned differentialCheck(const String& input, uint32_t selector)
+{
+	auto options = getOptions(selector);
+	Random random(selector);
+
+	Records expected;
+	parsePull(input, options, expected);
+
+	unsigned failures{0};
+	Records actual;
+	parsePushBuffer(input, options, random, actual);
+	failures += compare(_F("push(buffer)"), expected, actual);
+
+	actual.clear();
+	parsePushStream(input, options, random, actual);
+	failures += compare(_F("push(stream)"), expected, actual);
+
+	// Fast path must give identical results to the state machine
+	actual.clear();
+	auto fullOptions = options;
+	fullOptions.fastPath = false;
+	parsePull(input, fullOptions, actual);
+	failures += compare(_F("full parser"), expected, actual);
+
+	if(failures != 0) {
+		Serial << _F("Selector ") << String(selector, HEX) << _F(", input:") << endl;
+		m_printHex("  ", input.c_str(), input.length());
+	}
+	return failures;
+}
+
+#if CSV_FUZZ
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+	if(size < 4) {
+		return 0;
+	}
+	uint32_t selector;
+	memcpy(&selector, data, sizeof(selector));
+	String input(reinterpret_cast<const char*>(data) + 4, size - 4);
+	if(differentialCheck(input, selector) != 0) {
+		abort();
+	}
+	return 0;
+}
+
+extern "C" int LLVMFuzzerRunDriver(int* argc, char*** argv, int (*callback)(const uint8_t* data, size_t size));
+
+#endif
+
+class FuzzTest : public TestGroup
+{
+public:
+	FuzzTest() : TestGroup(_F("Differential test"))
+	{
+	}
+
+	void execute() override
+	{
+#if CSV_FUZZ
+		// Hand over to libFuzzer, which runs until stopped or a failure is found
+		int argc{1};
+		char arg0[]{"csvtest"};
+		char* args[]{arg0, nullptr};
+		char** argv{args};
+		LLVMFuzzerRunDriver(&argc, &argv, LLVMFuzzerTestOneInput);
+#else
+		// Generate inputs using characters significant to parser
+		static constexpr char alphabet[]{'a', 'b', ' ', ',', ';', '\t', '"', '\'', '\n', '\r', '#', '\\'};
+		const unsigned iterations{2000};
+		Random random(0x12345678);
+		unsigned failures{0};
+		for(unsigned i = 0; i < iterations && failures == 0; ++i) {
+			String input;
+			auto len = random(400);
+			for(unsigned j = 0; j < len; ++j) {
+				input += alphabet[random(sizeof(alphabet))];
+			}
+			failures += differentialCheck(input, random.next());
+		}
+		CHECK_EQ(failures, 0U);
+#endif
+	}
+};
+
+void REGISTER_TEST(fuzz)
+{
+	registerGroup<FuzzTest>();
+}
@@ -0,0 +1,125 @@
+#include <SmingTest.h>
+#include <CSV/IncrementalParser.h>
+#include <vector>
+
+using Status = CSV::IncrementalParser::Status;
+using Budget = CSV::IncrementalParser::Budget;
+
+namespace
+{
+String createInput()
+{
+	String s;
+	for(unsigned i = 0; i < 300; ++i) {
+		s += i;
+		s += ",\"Record ";
+		s += i;
+		s += "\"\r\n";
+	}
+	// Final record has no line ending
+	s += "300,last";
+	return s;
+}
+
+/*
+ * Process all queued data, counting the slices required
+ */
+Status drain(CSV::IncrementalParser& parser, unsigned& slices)
+{
+	for(;;) {
+		auto status = parser.process();
+		++slices;
+		if(status != Status::yield) {
+			return status;
+		}
+	}
+}
+
+} // namespace
+
+class IncrementalTest : public TestGroup
+{
+public:
+	IncrementalTest() : TestGroup(_F("Incremental parser"))
+	{
+	}
+
+	void execute() override
+	{
+		const String input = createInput();
+
+		std::vector<String> expected;
+		{
+			CSV::Parser parser(CSV::Parser::Options{});
+			size_t offset{0};
+			while(parser.push(input.c_str(), input.length(), offset)) {
+				expected.push_back(parser.getRow().join(";"));
+			}
+			while(parser.flush()) {
+				expected.push_back(parser.getRow().join(";"));
+			}
+		}
+		REQUIRE_EQ(expected.size(), 301U);
+
+		std::vector<String> rows;
+		auto addRow = [&rows](const CStringArray& row) {
+			rows.push_back(row.join(";"));
+			return true;
+		};
+
+		TEST_CASE("Byte budget")
+		{
+			CSV::IncrementalParser parser(CSV::Parser::Options{}, addRow, Budget{.bytes = 128});
+			unsigned slices{0};
+			for(size_t pos = 0; pos < input.length(); pos += 1000) {
+				auto len = std::min(size_t(1000), input.length() - pos);
+				REQUIRE_EQ(parser.write(input.c_str() + pos, len), len);
+				CHECK_EQ(parser.getPending(), len);
+				// Each slice stops after the record which exhausts the budget
+				auto streamPos = parser.getCursor().end;
+				while(parser.process() == Status::yield) {
+					++slices;
+					CHECK(parser.getCursor().end - streamPos < 128U + 20);
+					streamPos = parser.getCursor().end;
+				}
+				CHECK(parser.getStatus() == Status::needData);
+				CHECK_EQ(parser.getPending(), 0U);
+			}
+			CHECK(slices > input.length() / 1000);
+			CHECK(rows.size() < expected.size());
+			parser.end();
+			CHECK(drain(parser, slices) == Status::complete);
+			CHECK(rows == expected);
+			CHECK(parser.process() == Status::complete);
+		}
+
+		TEST_CASE("Time budget")
+		{
+			rows.clear();
+			CSV::IncrementalParser parser(CSV::Parser::Options{}, addRow, Budget{.bytes = 0, .time = 1});
+			parser.write(input.c_str(), input.length());
+			parser.end();
+			unsigned slices{0};
+			CHECK(drain(parser, slices) == Status::complete);
+			CHECK(slices > 1);
+			CHECK(rows == expected);
+		}
+
+		TEST_CASE("Abort")
+		{
+			unsigned count{0};
+			CSV::IncrementalParser parser(
+				CSV::Parser::Options{}, [&count](const CStringArray&) { return ++count < 10; }, Budget{.bytes = 0});
+			parser.write(input.c_str(), input.length());
+			CHECK(parser.process() == Status::aborted);
+			CHECK_EQ(count, 10U);
+			CHECK(parser.process() == Status::aborted);
+			CHECK_EQ(count, 10U);
+		}
+	}
+};
+
+void REGISTER_TEST(incremental)
+{
+	registerGroup<IncrementalTest>();
+}
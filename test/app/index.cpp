@@ -0,0 +1,103 @@
+#include <SmingTest.h>
+#include <CSV/Index.h>
+#include <Data/Stream/MemoryDataStream.h>
+
+class IndexTest : public TestGroup
+{
+public:
+	IndexTest() : TestGroup(_F("Index test"))
+	{
+	}
+
+	void execute() override
+	{
+		enum Column {
+			col_codes,
+			col_coordinates,
+			col_tz,
+		};
+
+		CSV::Reader reader(new FileStream(F("zone1970.tab")), CSV::Parser::Options{
+																  .commentChars = "#",
+																  .fieldSeparator = '\t',
+															  });
+		REQUIRE(reader);
+
+		unsigned europeCount{0};
+		while(reader.next()) {
+			if(String(reader.getValue(col_tz)).startsWith(F("Europe/"))) {
+				++europeCount;
+			}
+		}
+
+		CSV::Index index;
+		REQUIRE(index.build(reader, col_tz));
+		Serial << _F("Index contains ") << index.count() << _F(" entries") << endl;
+
+		TEST_CASE("Exact lookup")
+		{
+			REQUIRE(index.find(reader, "Europe/London"));
+			CHECK(F("GB,GG,IM,JE") == reader.getValue(col_codes));
+			REQUIRE(index.find(reader, "Europe/Paris"));
+			CHECK(F("FR,MC") == reader.getValue(col_codes));
+			CHECK(!index.find(reader, "Europe/Lon"));
+			CHECK(!index.find(reader, "Atlantis/Central"));
+		}
+
+		TEST_CASE("Prefix lookup")
+		{
+			unsigned mismatches{0};
+			auto count = index.findPrefix(reader, "Europe/", [&](CSV::Reader& reader) {
+				if(!String(reader.getValue(col_tz)).startsWith(F("Europe/"))) {
+					++mismatches;
+				}
+				return true;
+			});
+			Serial << count << _F(" zones in Europe") << endl;
+			CHECK_EQ(count, europeCount);
+			CHECK_EQ(mismatches, 0U);
+
+			count = index.findPrefix(reader, "Europe/", [](CSV::Reader&) { return false; });
+			CHECK_EQ(count, 1U);
+		}
+
+		TEST_CASE("Save and load")
+		{
+			MemoryDataStream stream;
+			REQUIRE(index.save(stream));
+			CSV::Index index2;
+			REQUIRE(index2.load(stream));
+			CHECK_EQ(index2.count(), index.count());
+			CHECK_EQ(index2.getColumn(), unsigned(col_tz));
+			REQUIRE(index2.find(reader, "America/New_York"));
+			CHECK(F("US") == reader.getValue(col_codes));
+		}
+
+		TEST_CASE("Load invalid data")
+		{
+			MemoryDataStream stream;
+			REQUIRE(index.save(stream));
+			String data;
+			stream.moveString(data);
+
+			// Record count larger than data
+			String corrupt = data;
+			uint32_t count{0x7fffffff};
+			memcpy(corrupt.begin() + 8, &count, sizeof(count));
+			MemoryDataStream corruptStream(std::move(corrupt));
+			CSV::Index index2;
+			CHECK(!index2.load(corruptStream));
+			CHECK_EQ(index2.count(), 0U);
+
+			// Truncated
+			MemoryDataStream truncated(data.substring(0, data.length() - 1));
+			CHECK(!index2.load(truncated));
+			CHECK_EQ(index2.count(), 0U);
+		}
+	}
+};
+
+void REGISTER_TEST(index)
+{
+	registerGroup<IndexTest>();
+}
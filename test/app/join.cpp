@@ -0,0 +1,188 @@
+#include <SmingTest.h>
+#include <CSV/HashJoin.h>
+#include <Data/Stream/MemoryDataStream.h>
+#include <WVector.h>
+
+namespace
+{
+DEFINE_FSTR_LOCAL(colours_csv, "id,colour,code\n"
+							   "1,red,R\n"
+							   "2,green,G\n"
+							   "1,crimson,C\n"
+							   ",none,N\n"
+							   "3,blue,B\n")
+
+DEFINE_FSTR_LOCAL(items_csv, "item,id\n"
+							 "apple,1\n"
+							 "sky,3\n"
+							 "coal,4\n"
+							 "grass,2\n"
+							 "nothing,\n")
+
+enum Column {
+	col_codes,
+	col_coordinates,
+	col_tz,
+};
+
+/*
+ * Events referring to time zones by name, some unknown
+ */
+IDataSourceStream* createEvents(const Vector<String>& zones, unsigned count)
+{
+	auto stream = new MemoryDataStream;
+	stream->print("event,tz\n");
+	for(unsigned i = 0; i < count; ++i) {
+		stream->print(i);
+		stream->print(',');
+		if(i % 10 == 9) {
+			stream->print("Nowhere/");
+			stream->print(i);
+		} else {
+			stream->print(zones[(i * 7) % zones.count()]);
+		}
+		stream->print('\n');
+	}
+	return stream;
+}
+
+} // namespace
+
+class JoinTest : public TestGroup
+{
+public:
+	JoinTest() : TestGroup(_F("Hash join"))
+	{
+	}
+
+	void execute() override
+	{
+		TEST_CASE("Inner join")
+		{
+			CSV::Reader colours(new FSTR::Stream(colours_csv));
+			CSV::Reader items(new FSTR::Stream(items_csv));
+			CSV::HashJoin join;
+			REQUIRE(join.build(colours, 0, {1}));
+			CHECK_EQ(join.count(), 4U);
+
+			String result;
+			auto count = join.join(items, 1, [&](CSV::Reader& probe, const CSV::HashJoin::Match& match) {
+				result += probe.getValue("item");
+				result += '=';
+				result += match.fields[0];
+				result += ';';
+				return true;
+			});
+			CHECK_EQ(count, 4U);
+			CHECK_EQ(result, F("apple=red;apple=crimson;sky=blue;grass=green;"));
+		}
+
+		TEST_CASE("Left outer join")
+		{
+			CSV::Reader colours(new FSTR::Stream(colours_csv));
+			CSV::Reader items(new FSTR::Stream(items_csv));
+			CSV::HashJoin join;
+			REQUIRE(join.build(colours, 0));
+
+			String result;
+			auto count = join.join(
+				items, 1,
+				[&](CSV::Reader& probe, const CSV::HashJoin::Match& match) {
+					CHECK(!match.fields);
+					result += probe.getValue("item");
+					result += '=';
+					if(match.record == CSV::Parser::BOF) {
+						result += '-';
+					} else {
+						// Fetch joined record from build table
+						REQUIRE(colours.seek(match.record));
+						result += colours.getValue("code");
+					}
+					result += ';';
+					return true;
+				},
+				true);
+			CHECK_EQ(count, 6U);
+			CHECK_EQ(result, F("apple=R;apple=C;sky=B;coal=-;grass=G;nothing=-;"));
+		}
+
+		TEST_CASE("Stop early")
+		{
+			CSV::Reader colours(new FSTR::Stream(colours_csv));
+			CSV::Reader items(new FSTR::Stream(items_csv));
+			CSV::HashJoin join;
+			REQUIRE(join.build(colours, 0, {1, 2}));
+			auto count = join.join(items, 1, [](CSV::Reader&, const CSV::HashJoin::Match& match) {
+				return strcmp(match.fields[1], "C") != 0;
+			});
+			CHECK_EQ(count, 2U);
+			// Probe reader continues with following record
+			CHECK_EQ(join.join(items, 1, nullptr), 2U);
+		}
+
+		TEST_CASE("Time zones")
+		{
+			CSV::Reader zones(new FileStream(F("zone1970.tab")), CSV::Parser::Options{
+																	 .commentChars = "#",
+																	 .fieldSeparator = '\t',
+																 });
+			REQUIRE(zones);
+			Vector<String> names;
+			while(zones.next()) {
+				names.add(zones.getValue(col_tz));
+			}
+
+			CSV::HashJoin join;
+			REQUIRE(join.build(zones, col_tz, {col_codes}));
+			CHECK_EQ(join.count(), names.count());
+			Serial << _F("Build table for ") << join.count() << _F(" zones uses ") << join.getMemoryUsed()
+				   << _F(" bytes") << endl;
+
+			const unsigned eventCount{1000};
+			CSV::Reader events(createEvents(names, eventCount));
+			unsigned mismatches{0};
+			auto count = join.join(events, 1, [&](CSV::Reader& probe, const CSV::HashJoin::Match& match) {
+				// Check stored fields against build table
+				if(!zones.seek(match.record) || strcmp(zones.getValue(col_tz), probe.getValue(1)) != 0 ||
+				   strcmp(zones.getValue(col_codes), match.fields[0]) != 0) {
+					++mismatches;
+				}
+				return true;
+			});
+			CHECK_EQ(count, eventCount - eventCount / 10);
+			CHECK_EQ(mismatches, 0U);
+
+			TEST_CASE("Memory limit")
+			{
+				CSV::HashJoin limited(join.getMemoryUsed() / 2);
+				CHECK(!limited.build(zones, col_tz, {col_codes}));
+				CHECK(limited.getError() == CSV::HashJoin::Error::noMemory);
+				CHECK_EQ(limited.count(), 0U);
+				CHECK_EQ(limited.getMemoryUsed(), 0U);
+			}
+		}
+
+		TEST_CASE("Record too long")
+		{
+			auto stream = new MemoryDataStream;
+			stream->print("key,value\n");
+			String value;
+			REQUIRE(value.setLength(30000));
+			memset(value.begin(), 'x', value.length());
+			stream->print("k,");
+			stream->print(value);
+			stream->print('\n');
+			CSV::Reader reader(stream, CSV::Parser::Options{.lineLength = 32000});
+			CSV::HashJoin join;
+			// Field is stored three times
+			CHECK(!join.build(reader, 0, {1, 1, 1}));
+			CHECK(join.getError() == CSV::HashJoin::Error::recordTooLong);
+			CHECK_EQ(join.count(), 0U);
+		}
+	}
+};
+
+void REGISTER_TEST(join)
+{
+	registerGroup<JoinTest>();
+}
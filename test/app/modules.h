@@ -2,4 +2,23 @@
 
 #define TEST_MAP(XX)                                                                                                   \
 	XX(parser)                                                                                                         \
-	XX(reader)
+	XX(reader)                                                                                                         \
+	XX(pipeline)                                                                                                       \
+	XX(index)                                                                                                          \
+	XX(aggregate)                                                                                                      \
+	XX(sniffer)                                                                                                        \
+	XX(fuzz)                                                                                                           \
+	XX(flashtable)                                                                                                     \
+	XX(codegen)                                                                                                        \
+	XX(multireader)                                                                                                    \
+	XX(stringpool)                                                                                                     \
+	XX(parallel)                                                                                                       \
+	XX(cache)                                                                                                          \
+	XX(incremental)                                                                                                    \
+	XX(async)                                                                                                          \
+	XX(zonemap)                                                                                                        \
+	XX(diff)                                                                                                           \
+	XX(sort)                                                                                                           \
+	XX(join)                                                                                                           \
+	XX(profile)                                                                                                        \
+	XX(columnfile)
@@ -0,0 +1,102 @@
+#include <SmingTest.h>
+#include <CSV/MultiReader.h>
+#include <WVector.h>
+
+DEFINE_FSTR_LOCAL(shard0, "a,b\n1,2\n3,4\n")
+DEFINE_FSTR_LOCAL(shard1, "a,b\n5,6\n")
+DEFINE_FSTR_LOCAL(shard2, "a,b\n")
+DEFINE_FSTR_LOCAL(shard3, "a,b\r\n7,8")
+DEFINE_FSTR_LOCAL(badShard, "a,c\n9,10\n")
+
+class MultiReaderTest : public TestGroup
+{
+public:
+	MultiReaderTest() : TestGroup(_F("Multi-reader test"))
+	{
+	}
+
+	void execute() override
+	{
+		TEST_CASE("Iterate shards")
+		{
+			const FSTR::String* shards[]{&shard0, &shard1, &shard2, &shard3};
+			String log;
+			CSV::MultiReader reader(
+				[&](unsigned shard) -> IDataSourceStream* {
+					log += shard;
+					if(shard >= std::size(shards)) {
+						return nullptr;
+					}
+					return new FSTR::Stream(*shards[shard]);
+				},
+				CSV::Parser::Options{});
+			REQUIRE(reader);
+			// Second shard is opened ahead of time
+			CHECK_EQ(log, "01");
+			CHECK_EQ(reader.count(), 2U);
+
+			String values;
+			Vector<CSV::MultiReader::Position> positions;
+			while(reader.next()) {
+				values += reader.getValue("a");
+				values += reader.getValue(1);
+				positions.add(reader.tell());
+			}
+			CHECK_EQ(values, "12345678");
+			CHECK_EQ(log, "01234");
+			CHECK(!reader);
+
+			REQUIRE_EQ(positions.count(), 4U);
+			CHECK_EQ(positions[2].shard, 1U);
+			CHECK_EQ(positions[3].shard, 3U);
+
+			// Seek in reverse order
+			for(unsigned i = positions.count(); i-- != 0;) {
+				REQUIRE(reader.seek(positions[i]));
+				CHECK_EQ(reader.getShard(), positions[i].shard);
+				CHECK_EQ(String(reader.getValue("a")), values.substring(i * 2, i * 2 + 1));
+			}
+
+			reader.reset();
+			CHECK_EQ(reader.getShard(), 0U);
+			REQUIRE(reader.next());
+			CHECK_EQ(String(reader.getValue("b")), "2");
+		}
+
+		TEST_CASE("Mismatched headings")
+		{
+			const FSTR::String* shards[]{&shard0, &badShard, &shard1};
+			CSV::MultiReader reader(
+				[&](unsigned shard) -> IDataSourceStream* {
+					return (shard < std::size(shards)) ? new FSTR::Stream(*shards[shard]) : nullptr;
+				},
+				CSV::Parser::Options{}, nullptr, false);
+			unsigned count{0};
+			while(reader.next()) {
+				++count;
+			}
+			CHECK_EQ(count, 2U);
+			CHECK_EQ(reader.getShard(), 1U);
+			CHECK(!reader);
+		}
+
+		TEST_CASE("Files")
+		{
+			CStringArray filenames;
+			filenames.add("addresses.csv");
+			filenames.add("addresses.csv");
+			filenames.add("addresses.csv");
+			CSV::MultiReader reader(filenames, CSV::Parser::Options{});
+			unsigned count{0};
+			while(reader.next()) {
+				++count;
+			}
+			CHECK_EQ(count, 6U);
+		}
+	}
+};
+
+void REGISTER_TEST(multireader)
+{
+	registerGroup<MultiReaderTest>();
+}
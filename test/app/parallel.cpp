@@ -0,0 +1,152 @@
+#include <SmingTest.h>
+#include <CSV/Parallel.h>
+#include <CSV/Aggregate.h>
+#include <WVector.h>
+
+#ifdef ARCH_HOST
+
+using Options = CSV::Parser::Options;
+
+namespace
+{
+struct Zone : public CSV::Record {
+	using Record::Record;
+
+	const char* codes() const
+	{
+		return row[0];
+	}
+
+	const char* tz() const
+	{
+		return row[2];
+	}
+};
+
+struct Totals {
+	unsigned records{0};
+	unsigned countryCodes{0};
+	CSV::Stats nameLength;
+
+	void merge(const Totals& other)
+	{
+		records += other.records;
+		countryCodes += other.countryCodes;
+		nameLength.merge(other.nameLength);
+	}
+};
+
+unsigned countCodes(const char* codes)
+{
+	unsigned count{1};
+	for(; *codes; ++codes) {
+		if(*codes == ',') {
+			++count;
+		}
+	}
+	return count;
+}
+
+} // namespace
+
+class ParallelTest : public TestGroup
+{
+public:
+	ParallelTest() : TestGroup(_F("Parallel test"))
+	{
+	}
+
+	void execute() override
+	{
+		const Options options{
+			.commentChars = "#",
+			.fieldSeparator = '\t',
+		};
+		const CSV::Scheduler::Settings settings{
+			.threads = 4,
+			.batchSize = 4,
+		};
+
+		Totals expected;
+		Vector<String> names;
+		{
+			CSV::Table<Zone> table(new FileStream(F("zone1970.tab")), options);
+			for(auto zone : table) {
+				++expected.records;
+				expected.countryCodes += countCodes(zone.codes());
+				expected.nameLength.addValue(strlen(zone.tz()));
+				names.add(zone.tz());
+			}
+		}
+
+		TEST_CASE("parallelForEach with accumulator")
+		{
+			CSV::Table<Zone> table(new FileStream(F("zone1970.tab")), options);
+			auto totals = CSV::parallelForEach(
+				table, Totals{},
+				[](Totals& acc, const Zone& zone) {
+					++acc.records;
+					acc.countryCodes += countCodes(zone.codes());
+					acc.nameLength.addValue(strlen(zone.tz()));
+				},
+				settings);
+			CHECK_EQ(totals.records, expected.records);
+			CHECK_EQ(totals.countryCodes, expected.countryCodes);
+			CHECK_EQ(totals.nameLength.min, expected.nameLength.min);
+			CHECK_EQ(totals.nameLength.max, expected.nameLength.max);
+			CHECK_EQ(totals.nameLength.sum, expected.nameLength.sum);
+		}
+
+		TEST_CASE("parallelForEach")
+		{
+			CSV::Table<Zone> table(new FileStream(F("zone1970.tab")), options);
+			std::atomic<unsigned> count{0};
+			auto recordCount = CSV::parallelForEach(table, [&](const Zone&) { ++count; }, settings);
+			CHECK_EQ(recordCount, expected.records);
+			CHECK_EQ(count, expected.records);
+		}
+
+		TEST_CASE("parallelMap")
+		{
+			CSV::Table<Zone> table(new FileStream(F("zone1970.tab")), options);
+			auto result = CSV::parallelMap<String>(table, [](const Zone& zone) { return String(zone.tz()); }, settings);
+			REQUIRE_EQ(result.size(), names.count());
+			unsigned mismatches{0};
+			for(unsigned i = 0; i < result.size(); ++i) {
+				if(result[i] != names[i]) {
+					++mismatches;
+				}
+			}
+			CHECK_EQ(mismatches, 0U);
+		}
+
+		TEST_CASE("Work stealing")
+		{
+			// Block worker 0 on its first batch until all others are done, so they must take its queued batches
+			CSV::Reader reader(new FileStream(F("zone1970.tab")), options);
+			CSV::Scheduler scheduler(reader, settings);
+			std::atomic<unsigned> count{0};
+			scheduler.run([&](unsigned worker, const CSV::Batch& batch) {
+				if(worker == 0) {
+					auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+					while(count + batch.count() < expected.records && std::chrono::steady_clock::now() < deadline) {
+						std::this_thread::sleep_for(std::chrono::milliseconds(1));
+					}
+				}
+				count += batch.count();
+			});
+			Serial << _F("Stole ") << scheduler.getStealCount() << _F(" batches") << endl;
+			CHECK_EQ(count, expected.records);
+			CHECK(scheduler.getStealCount() != 0);
+		}
+	}
+};
+
+#endif // ARCH_HOST
+
+void REGISTER_TEST(parallel)
+{
+#ifdef ARCH_HOST
+	registerGroup<ParallelTest>();
+#endif
+}
@@ -2,6 +2,7 @@
 #include <CSV/Parser.h>
 #include <malloc_count.h>
 #include <WVector.h>
+#include <Data/Stream/MemoryDataStream.h>
 
 // 0: Normal
 // 1: Generate output comparison files (host only)
@@ -75,6 +76,116 @@ public:
 					  .fieldSeparator = ',',
 				  },
 				  Mode::dump);
+
+		TEST_CASE("Checkpoint and resume")
+		{
+			checkpointFile(F("addresses.csv"), Options{});
+			checkpointFile(F("zone1970.tab"), Options{
+												  .commentChars = "#",
+												  .fieldSeparator = '\t',
+											  });
+		}
+
+		TEST_CASE("Push complete records")
+		{
+			CSV::Parser parser(Options{});
+			size_t offset{0};
+
+			// Complete record is returned without waiting for buffer to fill
+			String data = "a,b\n";
+			REQUIRE(parser.push(data.c_str(), data.length(), offset));
+			CHECK(F("a;b") == parser.getRow().join(";"));
+			CHECK_EQ(offset, data.length());
+
+			// Line break within quotes does not complete record
+			data = "\"c\nd\",e";
+			offset = 0;
+			CHECK(!parser.push(data.c_str(), data.length(), offset));
+			data = "\n";
+			offset = 0;
+			REQUIRE(parser.push(data.c_str(), data.length(), offset));
+			CHECK(F("c\nd;e") == parser.getRow().join(";"));
+
+			// Partial record
+			data = "f,g";
+			offset = 0;
+			CHECK(!parser.push(data.c_str(), data.length(), offset));
+			REQUIRE(parser.flush());
+			CHECK(F("f;g") == parser.getRow().join(";"));
+			CHECK(!parser.flush());
+		}
+
+		TEST_CASE("Push records with comments")
+		{
+			CSV::Parser parser(Options{.commentChars = "#"});
+			size_t offset{0};
+
+			// Quote within comment is ignored
+			String data = "#\"\na,b\n";
+			REQUIRE(parser.push(data.c_str(), data.length(), offset));
+			CHECK(F("a;b") == parser.getRow().join(";"));
+			CHECK_EQ(offset, data.length());
+
+			// Comment character within a field is data, and does not delay the record
+			data = "c#,d\n";
+			offset = 0;
+			REQUIRE(parser.push(data.c_str(), data.length(), offset));
+			CHECK(F("c#;d") == parser.getRow().join(";"));
+
+			// Record completed over several pushes, comment character within quotes is data
+			data = "e,\"f";
+			offset = 0;
+			CHECK(!parser.push(data.c_str(), data.length(), offset));
+			data = "\n#";
+			offset = 0;
+			CHECK(!parser.push(data.c_str(), data.length(), offset));
+			data = "\",g\n";
+			offset = 0;
+			REQUIRE(parser.push(data.c_str(), data.length(), offset));
+			CHECK(F("e;f\n#;g") == parser.getRow().join(";"));
+		}
+
+		TEST_CASE("Push long records")
+		{
+			// Records longer than buffer must be divided the same as by readRow()
+			String data;
+			for(unsigned i = 0; i < 3; ++i) {
+				data += String(i);
+				data += ',';
+				for(unsigned j = 0; j < 300 * (i + 1); ++j) {
+					data += char('a' + j % 26);
+				}
+				data += '\n';
+			}
+			const Options options{.lineLength = 64};
+
+			Vector<String> expected;
+			CSV::Parser parser1(options);
+			MemoryDataStream stream;
+			stream.print(data);
+			while(parser1.readRow(stream)) {
+				expected.add(parser1.getRow().join(";"));
+			}
+
+			Vector<String> actual;
+			CSV::Parser parser2(options);
+			for(size_t pos = 0; pos < data.length(); pos += 7) {
+				size_t offset{0};
+				auto len = std::min(size_t(7), data.length() - pos);
+				while(parser2.push(data.c_str() + pos, len, offset)) {
+					actual.add(parser2.getRow().join(";"));
+				}
+			}
+			while(parser2.flush()) {
+				actual.add(parser2.getRow().join(";"));
+			}
+
+			REQUIRE_EQ(actual.count(), expected.count());
+			CHECK(expected.count() > 3);
+			for(unsigned i = 0; i < expected.count(); ++i) {
+				CHECK(actual[i] == expected[i]);
+			}
+		}
 	}
 
 private:
@@ -159,6 +270,73 @@ private:
 		}
 	}
 
+	/*
+	 * Parse file in one go, then again with an interruption half-way through,
+	 * saving and restoring a checkpoint. Results should be identical.
+	 */
+	void checkpointFile(const String& filename, const Options& options)
+	{
+		Serial << endl << _F(">> Checkpoint file '") << filename << '\'' << endl;
+
+		Vector<String> rows;
+		REQUIRE(file.open(filename));
+		parser = std::make_unique<CSV::Parser>(options);
+		pushFile([&]() {
+			rows.add(parser->getRow().join("|"));
+			return true;
+		});
+
+		MemoryDataStream stream;
+		unsigned rowIndex{0};
+		REQUIRE(file.open(filename));
+		parser = std::make_unique<CSV::Parser>(options);
+		pushFile([&]() {
+			CHECK(rows[rowIndex] == parser->getRow().join("|"));
+			++rowIndex;
+			if(rowIndex < rows.count() / 2) {
+				return true;
+			}
+			CHECK(parser->getCheckpoint().save(stream));
+			return false;
+		});
+
+		CSV::Parser::Checkpoint checkpoint;
+		REQUIRE(checkpoint.load(stream));
+		Serial << _F("Resume at ") << checkpoint.sourcePos << _F(", pending ") << checkpoint.pending.length()
+			   << endl;
+		parser = std::make_unique<CSV::Parser>(options);
+		REQUIRE(parser->restore(checkpoint));
+		REQUIRE(file.seek(checkpoint.sourcePos, SeekOrigin::Start) == int(checkpoint.sourcePos));
+		pushFile([&]() {
+			CHECK(rowIndex < rows.count() && rows[rowIndex] == parser->getRow().join("|"));
+			++rowIndex;
+			return true;
+		});
+		CHECK_EQ(rowIndex, rows.count());
+	}
+
+	/*
+	 * Push file content through parser, stopping early if callback returns false
+	 */
+	template <typename Callback> void pushFile(Callback callback)
+	{
+		char buffer[55];
+		int len;
+		while((len = file.read(buffer, sizeof(buffer))) > 0) {
+			size_t offset{0};
+			while(parser->push(buffer, len, offset)) {
+				if(!callback()) {
+					return;
+				}
+			}
+		}
+		while(parser->flush()) {
+			if(!callback()) {
+				return;
+			}
+		}
+	}
+
 	bool handleRow()
 	{
 		auto& row = parser->getRow();
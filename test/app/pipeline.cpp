@@ -0,0 +1,78 @@
+#include <SmingTest.h>
+#include <CSV/Pipeline.h>
+#include <WVector.h>
+
+#ifdef ARCH_HOST
+
+using Options = CSV::Parser::Options;
+
+class PipelineTest : public TestGroup
+{
+public:
+	PipelineTest() : TestGroup(_F("Pipeline test"))
+	{
+	}
+
+	void execute() override
+	{
+		const Options options{
+			.commentChars = "#",
+			.fieldSeparator = '\t',
+		};
+
+		Vector<CSV::Cursor> cursors;
+		size_t totalRowSize{0};
+		{
+			CSV::Reader reader(new FileStream(F("zone1970.tab")), options);
+			REQUIRE(reader);
+			while(reader.next()) {
+				cursors.add(reader.getCursor());
+				totalRowSize += reader.getRow().length();
+			}
+		}
+		Serial << _F("Sequential read ") << cursors.count() << _F(" records") << endl;
+
+		TEST_CASE("Ordered completion")
+		{
+			CSV::Reader reader(new FileStream(F("zone1970.tab")), options);
+			CSV::Pipeline pipeline(reader, {
+											   .threads = 4,
+											   .batchSize = 8,
+										   });
+
+			std::atomic<size_t> rowSize{0};
+			unsigned index{0};
+			unsigned mismatches{0};
+			auto count = pipeline.run(
+				[&](unsigned worker, const CSV::Batch& batch) {
+					for(unsigned i = 0; i < batch.count(); ++i) {
+						rowSize += batch[i].length();
+					}
+				},
+				[&](const CSV::Batch& batch) {
+					for(unsigned i = 0; i < batch.count(); ++i, ++index) {
+						auto& cursor = batch.getCursor(i);
+						if(index >= cursors.count() || cursor.start != cursors[index].start) {
+							++mismatches;
+						}
+					}
+				});
+
+			Serial << _F("Pipeline processed ") << count << _F(" records using ") << pipeline.getThreadCount()
+				   << _F(" threads") << endl;
+			CHECK_EQ(count, cursors.count());
+			CHECK_EQ(index, cursors.count());
+			CHECK_EQ(mismatches, 0U);
+			CHECK_EQ(rowSize, totalRowSize);
+		}
+	}
+};
+
+#endif // ARCH_HOST
+
+void REGISTER_TEST(pipeline)
+{
+#ifdef ARCH_HOST
+	registerGroup<PipelineTest>();
+#endif
+}
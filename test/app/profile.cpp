@@ -0,0 +1,198 @@
+#include <SmingTest.h>
+#include <CSV/Profiler.h>
+#include <Data/Stream/MemoryDataStream.h>
+
+namespace
+{
+/*
+ * Records with unique id, 5 categories, a price, a mostly empty note
+ * and a trailing column missing from every 20th record
+ */
+IDataSourceStream* createData(unsigned count)
+{
+	auto stream = new MemoryDataStream;
+	stream->print("id,category,price,note,extra\n");
+	for(unsigned i = 0; i < count; ++i) {
+		stream->print(i);
+		stream->print(",cat");
+		stream->print(i % 5);
+		stream->print(',');
+		stream->print(i);
+		stream->print(".25,");
+		if(i % 4 == 0) {
+			stream->print("note ");
+			stream->print(i);
+		} else if(i == 1) {
+			stream->print("  ");
+		}
+		if(i % 20 != 0) {
+			stream->print(",x");
+		}
+		stream->print('\n');
+	}
+	return stream;
+}
+
+bool withinPercent(uint32_t estimate, uint32_t actual, unsigned percent)
+{
+	auto diff = (estimate > actual) ? estimate - actual : actual - estimate;
+	return diff * 100 <= actual * percent;
+}
+
+} // namespace
+
+class ProfileTest : public TestGroup
+{
+public:
+	ProfileTest() : TestGroup(_F("Profiler"))
+	{
+	}
+
+	void execute() override
+	{
+		TEST_CASE("HyperLogLog")
+		{
+			CSV::HyperLogLog hll(12);
+			CHECK_EQ(hll.getSize(), 4096U);
+			CHECK_EQ(hll.estimate(), 0U);
+
+			CSV::HyperLogLog half1(12);
+			CSV::HyperLogLog half2(12);
+			const unsigned count{20000};
+			for(unsigned i = 0; i < count; ++i) {
+				String value(i);
+				hll.add(value.c_str());
+				hll.add(value.c_str());
+				((i & 1) ? half1 : half2).add(value.c_str());
+			}
+			auto estimate = hll.estimate();
+			Serial << _F("Estimated ") << estimate << _F(" distinct values, actual ") << count << endl;
+			CHECK(withinPercent(estimate, count, 5));
+
+			REQUIRE(half1.merge(half2));
+			CHECK_EQ(half1.estimate(), estimate);
+			CHECK(!half1.merge(CSV::HyperLogLog(8)));
+
+			CSV::HyperLogLog small;
+			for(unsigned i = 0; i < 50; ++i) {
+				small.add(String(i).c_str());
+			}
+			CHECK(withinPercent(small.estimate(), 50, 5));
+		}
+
+		TEST_CASE("Length histogram")
+		{
+			CSV::LengthHistogram hist;
+			for(unsigned i = 0; i < 100; ++i) {
+				hist.add(i);
+			}
+			hist.add(100000);
+			CHECK_EQ(hist.count, 101U);
+			CHECK_EQ(hist.min, 0U);
+			CHECK_EQ(hist.max, 100000U);
+			CHECK_EQ(hist.bins[0], 1U);
+			CHECK_EQ(hist.bins[1], 1U);
+			CHECK_EQ(hist.bins[7], 36U);
+			CHECK_EQ(hist.bins[CSV::LengthHistogram::binCount - 1], 1U);
+			CHECK_EQ(hist.getLength(0.5), 63U);
+			CHECK_EQ(hist.getLength(0.99), 127U);
+			CHECK_EQ(hist.getLength(1), 100000U);
+		}
+
+		TEST_CASE("Profile")
+		{
+			const unsigned count{1000};
+			CSV::Reader reader(createData(count));
+			CSV::Profiler profiler;
+			CHECK_EQ(profiler.run(reader), count);
+			CHECK_EQ(profiler.getRecordCount(), count);
+			REQUIRE_EQ(profiler.count(), 5U);
+
+			auto& id = profiler[0];
+			CHECK_EQ(id.getType(), CSV::ValueType::integer);
+			CHECK_EQ(id.nullCount, 0U);
+			CHECK_EQ(id.numbers.min, 0.0);
+			CHECK_EQ(id.numbers.max, 999.0);
+			CHECK_EQ(id.lengths.max, 3U);
+			CHECK(withinPercent(id.getCardinality(), count, 15));
+
+			auto& category = profiler[1];
+			CHECK_EQ(category.getType(), CSV::ValueType::text);
+			CHECK_EQ(category.getCardinality(), 5U);
+			CHECK_EQ(category.lengths.min, 4U);
+			CHECK_EQ(category.lengths.max, 4U);
+
+			auto& price = profiler[2];
+			CHECK_EQ(price.getType(), CSV::ValueType::number);
+			CHECK_EQ(price.numbers.valueCount, count);
+			CHECK_EQ(price.numbers.max, 999.25);
+
+			auto& note = profiler[3];
+			CHECK_EQ(note.getEmptyCount(), count * 3 / 4);
+			CHECK_EQ(note.typeCounts[unsigned(CSV::ValueType::text)], count / 4);
+			CHECK_EQ(note.lengths.min, 0U);
+
+			auto& extra = profiler[4];
+			CHECK_EQ(extra.nullCount, count / 20);
+			CHECK_EQ(extra.numbers.count, count - count / 20);
+			CHECK_EQ(extra.getCardinality(), 1U);
+
+			// Record lengths from source
+			auto& lengths = profiler.getRecordLengths();
+			CHECK_EQ(lengths.count, count);
+			CHECK_EQ(lengths.min, 14U);
+			CHECK_EQ(lengths.max, 26U);
+		}
+
+		TEST_CASE("Field hashes and merge")
+		{
+			const unsigned count{1000};
+			CSV::Profiler expected;
+			{
+				CSV::Reader reader(createData(count));
+				expected.run(reader);
+			}
+
+			// Split data between two profilers, using hashes computed by parser
+			CSV::Reader reader(createData(count), CSV::Parser::Options{.hashFields = true});
+			CSV::Profiler profiler1;
+			CSV::Profiler profiler2;
+			CSV::Batch batch;
+			batch.fill(reader, 10);
+			profiler1.add(batch);
+			profiler2.run(reader);
+			REQUIRE(profiler1.merge(profiler2));
+			CHECK(!profiler1.merge(CSV::Profiler(10)));
+
+			CHECK_EQ(profiler1.getRecordCount(), count);
+			REQUIRE_EQ(profiler1.count(), expected.count());
+			for(unsigned i = 0; i < expected.count(); ++i) {
+				auto& col = profiler1[i];
+				auto& exp = expected[i];
+				CHECK_EQ(col.nullCount, exp.nullCount);
+				CHECK_EQ(col.getEmptyCount(), exp.getEmptyCount());
+				CHECK_EQ(col.getType(), exp.getType());
+				CHECK_EQ(col.lengths.max, exp.lengths.max);
+				CHECK_EQ(col.getCardinality(), exp.getCardinality());
+			}
+			CHECK_EQ(profiler1.getRecordLengths().max, expected.getRecordLengths().max);
+		}
+
+		TEST_CASE("Short records")
+		{
+			CSV::Profiler profiler;
+			profiler.add(CStringArray("a\0", 2));
+			profiler.add(CStringArray("b\0c\0", 4));
+			profiler.add(CStringArray("d\0", 2));
+			REQUIRE_EQ(profiler.count(), 2U);
+			CHECK_EQ(profiler[0].nullCount, 0U);
+			CHECK_EQ(profiler[1].nullCount, 2U);
+			CHECK_EQ(profiler.getRecordLengths().max, 4U);
+		}
+	}
+};
+
+void REGISTER_TEST(profile)
+{
+	registerGroup<ProfileTest>();
+}
@@ -1,5 +1,8 @@
 #include <SmingTest.h>
 #include <CSV/Reader.h>
+#include <CSV/Arena.h>
+#include <Data/Stream/MemoryDataStream.h>
+#include <WVector.h>
 
 DEFINE_FSTR_LOCAL(
 	test1_csv,
@@ -13,6 +16,12 @@ DEFINE_FSTR_LOCAL(csv_row1, "Something \"awry\";datavalue 2;where,are,\"the,\nba
 DEFINE_FSTR_LOCAL(csv_row2, "one;two;three;four")
 DEFINE_FSTR_LOCAL(csv_row3, "a;b;c;d;e;f")
 
+DEFINE_FSTR_LOCAL(test2_csv, "'one';two|'three;four'\n"
+							 "1;'two '' quote'|3\n")
+
+DEFINE_FSTR_LOCAL(test2_headings, "one,two,three;four")
+DEFINE_FSTR_LOCAL(test2_row1, "1,two ' quote,3")
+
 class ReaderTest : public TestGroup
 {
 public:
@@ -63,6 +72,33 @@ public:
 				REQUIRE(csv_row1 == row.join(sep));
 			}
 
+			TEST_CASE("checkpoint")
+			{
+				reader.seek(cursor1);
+				auto checkpoint = reader.getCheckpoint();
+				MemoryDataStream stream;
+				REQUIRE(checkpoint.save(stream));
+
+				CSV::Reader reader2(new FSTR::Stream(test1_csv));
+				CSV::Reader::Checkpoint checkpoint2;
+				REQUIRE(checkpoint2.load(stream));
+				REQUIRE(reader2.restore(checkpoint2));
+				CHECK_EQ(reader2.tell(), cursor1);
+				REQUIRE(csv_row1 == reader2.getRow().join(sep));
+				REQUIRE(reader2.next());
+				REQUIRE(csv_row2 == reader2.getRow().join(sep));
+
+				// Checkpoint before first record has no current row
+				CSV::Reader reader3(new FSTR::Stream(test1_csv), ',', CStringArray(F("heading")));
+				auto bofCheckpoint = reader3.getCheckpoint();
+				CHECK_EQ(bofCheckpoint.cursor.start, CSV::Parser::BOF);
+				reader3.next();
+				REQUIRE(reader3.restore(bofCheckpoint));
+				CHECK_EQ(reader3.getRow().count(), 0U);
+				REQUIRE(reader3.next());
+				REQUIRE(csv_headings == reader3.getRow().join(sep));
+			}
+
 			TEST_CASE("seek")
 			{
 				reader.seek(cursor2);
@@ -77,7 +113,121 @@ public:
 				row = reader.getRow();
 				REQUIRE(csv_row3 == row.join(sep));
 			}
+
+			TEST_CASE("reverse")
+			{
+				REQUIRE(reader.last());
+				CHECK_EQ(reader.tell(), cursor3);
+				REQUIRE(reader.prev());
+				CHECK_EQ(reader.tell(), cursor2);
+				// Contains quoted line break
+				REQUIRE(reader.prev());
+				CHECK_EQ(reader.tell(), cursor1);
+				REQUIRE(csv_row1 == reader.getRow().join(sep));
+				CHECK(!reader.prev());
+				CHECK(!reader.prev());
+				REQUIRE(reader.next());
+				CHECK_EQ(reader.tell(), cursor1);
+
+				// Step back from end
+				reader.seek(cursor3);
+				CHECK(!reader.next());
+				REQUIRE(reader.prev());
+				CHECK_EQ(reader.tell(), cursor3);
+				REQUIRE(csv_row3 == reader.getRow().join(sep));
+			}
+		}
+
+		TEST_CASE("Reverse scan")
+		{
+			reverseScan(F("zone1970.tab"), CSV::Parser::Options{
+											   .commentChars = "#",
+											   .fieldSeparator = '\t',
+										   });
+			reverseScan(F("test.csv"), CSV::Parser::Options{});
+		}
+
+		TEST_CASE("Separators and quote character")
+		{
+			CSV::Reader reader(new FSTR::Stream(test2_csv), CSV::Parser::Options{
+																.fieldSeparator = ';',
+																.fieldSeparators = "|",
+																.quoteChar = '\'',
+															});
+
+			auto headings = reader.getHeadings();
+			Serial.println(headings.join());
+			CHECK(test2_headings == headings.join());
+
+			REQUIRE(reader.next());
+			auto row = reader.getRow();
+			Serial.println(row.join());
+			CHECK(test2_row1 == row.join());
+
+			CHECK(!reader.next());
+		}
+
+		TEST_CASE("Retain rows in arena")
+		{
+			CSV::Reader reader(new FSTR::Stream(test1_csv));
+
+			char buffer[64];
+			CSV::Arena arena(buffer, sizeof(buffer), 32);
+			CSV::ArenaRow rows[3];
+			for(auto& row : rows) {
+				REQUIRE(reader.next());
+				row = arena.add(reader.getRow());
+				REQUIRE(row);
+			}
+			Serial << _F("Arena used ") << arena.getUsed() << _F(", capacity ") << arena.getCapacity() << endl;
+
+			const char* sep = ";";
+			CHECK(csv_row1 == rows[0].join(sep));
+			CHECK(csv_row2 == rows[1].join(sep));
+			CHECK(csv_row3 == rows[2].join(sep));
+			CHECK_EQ(rows[2].count(), 6U);
+			CHECK(strcmp(rows[2][5], "f") == 0);
+			CHECK(rows[2][6] == nullptr);
+
+			arena.clear();
+			CHECK_EQ(arena.getUsed(), 0U);
+			CHECK(arena.getCapacity() < sizeof(buffer));
+		}
+
+		TEST_CASE("Unaligned arena buffer")
+		{
+			alignas(8) char buffer[64];
+			CSV::Arena arena(buffer + 1, sizeof(buffer) - 1, 0);
+			REQUIRE(arena.getCapacity() != 0);
+			CHECK(arena.getCapacity() <= sizeof(buffer) - 8);
+			REQUIRE(arena.allocate(1, 1) != nullptr);
+			auto ptr = arena.allocate(4, 4);
+			REQUIRE(ptr != nullptr);
+			CHECK_EQ(uintptr_t(ptr) % 4, 0U);
+			CHECK_EQ(arena.getUsed(), 8U);
+		}
+	}
+
+private:
+	/*
+	 * Read file forwards then backwards and compare record locations
+	 */
+	void reverseScan(const String& filename, const CSV::Parser::Options& options)
+	{
+		CSV::Reader reader(new FileStream(filename), options);
+		REQUIRE(reader);
+		Vector<int> cursors;
+		while(reader.next()) {
+			cursors.add(reader.tell());
+		}
+		unsigned index = cursors.count();
+		while(reader.prev()) {
+			REQUIRE(index > 0);
+			--index;
+			CHECK_EQ(reader.tell(), cursors[index]);
 		}
+		CHECK_EQ(index, 0U);
+		Serial << filename << _F(": ") << cursors.count() << _F(" records") << endl;
 	}
 };
 
@@ -0,0 +1,124 @@
+#include <SmingTest.h>
+#include <CSV/Sniffer.h>
+
+DEFINE_FSTR_LOCAL(semicolon_csv, "id;name;price;stock\r\n"
+								 "1;Widget;2.50;10\r\n"
+								 "2;\"Gadget; deluxe\";12;0\r\n"
+								 "3;Sprocket;0.75;1234\r\n")
+
+DEFINE_FSTR_LOCAL(whitespace_txt, "# Whitespace-separated values\n"
+								  "alpha   1   2\n"
+								  "beta    3   4\n"
+								  "gamma   5   6\n")
+
+DEFINE_FSTR_LOCAL(apostrophe_csv, "name,score\n"
+								  "O'Brien,12\n"
+								  "D'Arcy,15\n"
+								  "Smith,9\n")
+
+DEFINE_FSTR_LOCAL(single_quoted_csv, "name,score\n"
+									 "'Smith, J',12\n"
+									 "'Jones',15\n")
+
+class SnifferTest : public TestGroup
+{
+public:
+	SnifferTest() : TestGroup(_F("Sniffer test"))
+	{
+	}
+
+	void execute() override
+	{
+		using ValueType = CSV::ValueType;
+
+		TEST_CASE("Semicolon with headings")
+		{
+			CSV::Sniffer::Result result;
+			auto reader = CSV::Sniffer::createReader(new FSTR::Stream(semicolon_csv), result);
+			REQUIRE(reader);
+			printResult(result);
+			CHECK_EQ(result.options.fieldSeparator, ';');
+			CHECK(result.hasHeadings);
+			CHECK(result.crlf);
+			CHECK(result.quoted);
+			REQUIRE_EQ(result.columnTypes.size(), 4U);
+			CHECK(result.columnTypes[0] == ValueType::integer);
+			CHECK(result.columnTypes[1] == ValueType::text);
+			CHECK(result.columnTypes[2] == ValueType::number);
+			CHECK(result.columnTypes[3] == ValueType::integer);
+
+			CHECK_EQ(reader->getColumn("price"), 2);
+			REQUIRE(reader->next());
+			REQUIRE(reader->next());
+			CHECK(F("Gadget; deluxe") == reader->getValue("name"));
+		}
+
+		TEST_CASE("Whitespace with comments")
+		{
+			CSV::Sniffer::Result result;
+			auto reader = CSV::Sniffer::createReader(new FSTR::Stream(whitespace_txt), result);
+			REQUIRE(reader);
+			printResult(result);
+			CHECK_EQ(result.options.fieldSeparator, '\0');
+			REQUIRE(result.options.commentChars != nullptr);
+			CHECK_EQ(*result.options.commentChars, '#');
+			CHECK(!result.hasHeadings);
+			CHECK_EQ(reader->count(), 3U);
+			REQUIRE(reader->next());
+			CHECK(F("alpha") == reader->getValue("1"));
+		}
+
+		TEST_CASE("Apostrophes in unquoted fields")
+		{
+			CSV::Sniffer::Result result;
+			auto reader = CSV::Sniffer::createReader(new FSTR::Stream(apostrophe_csv), result);
+			REQUIRE(reader);
+			printResult(result);
+			CHECK_EQ(result.options.quoteChar, '"');
+			CHECK(!result.quoted);
+			CHECK_EQ(result.recordCount, 4U);
+			REQUIRE(reader->next());
+			CHECK(F("O'Brien") == reader->getValue("name"));
+			REQUIRE(reader->next());
+			CHECK(F("D'Arcy") == reader->getValue("name"));
+			CHECK(F("15") == reader->getValue("score"));
+		}
+
+		TEST_CASE("Single quotes")
+		{
+			CSV::Sniffer::Result result;
+			auto reader = CSV::Sniffer::createReader(new FSTR::Stream(single_quoted_csv), result);
+			REQUIRE(reader);
+			CHECK_EQ(result.options.quoteChar, '\'');
+			CHECK(result.quoted);
+			REQUIRE(reader->next());
+			CHECK(F("Smith, J") == reader->getValue("name"));
+		}
+
+		TEST_CASE("Tab separated file")
+		{
+			FileStream stream(F("zone1970.tab"));
+			CSV::Sniffer::Result result;
+			REQUIRE(CSV::Sniffer::sniff(stream, result));
+			printResult(result);
+			CHECK_EQ(result.options.fieldSeparator, '\t');
+			CHECK(!result.hasHeadings);
+		}
+	}
+
+	void printResult(const CSV::Sniffer::Result& result)
+	{
+		auto& options = result.options;
+		Serial << _F("Separator ") << unsigned(options.fieldSeparator) << _F(", comment ")
+			   << (options.commentChars ?: "") << _F(", line length ") << options.lineLength << _F(", headings ")
+			   << result.hasHeadings << _F(", records ") << result.recordCount << endl;
+		for(auto type : result.columnTypes) {
+			Serial << "  " << toString(type) << endl;
+		}
+	}
+};
+
+void REGISTER_TEST(sniffer)
+{
+	registerGroup<SnifferTest>();
+}
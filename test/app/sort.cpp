@@ -0,0 +1,209 @@
+#include <SmingTest.h>
+#include <CSV/ExternalSort.h>
+#include <CSV/Reader.h>
+
+#ifdef ARCH_HOST
+
+#include <IFS/Host/FileSystem.h>
+
+namespace
+{
+constexpr unsigned recordCount{2000};
+
+DEFINE_FSTR_LOCAL(inputFile, "out/sort-input.csv")
+DEFINE_FSTR_LOCAL(outputFile, "out/sort-output.csv")
+DEFINE_FSTR_LOCAL(header, "# Test data\n"
+						  "id,name,score\n")
+
+enum Column {
+	col_id,
+	col_name,
+	col_score,
+};
+
+bool createInput(IFS::FileSystem& fs)
+{
+	FileStream file(&fs);
+	if(!file.open(inputFile, File::CreateNewAlways | File::WriteOnly)) {
+		return false;
+	}
+	file.print(header);
+	for(unsigned i = 0; i < recordCount; ++i) {
+		file.print(i);
+		auto n = (i * 7919) % recordCount;
+		if(n % 5 == 0) {
+			// Quoted, with embedded separator and line break
+			file.print(",\"Name, ");
+			file.print(n);
+			file.print("\nsecond line\",");
+		} else {
+			file.print(",Name ");
+			file.print(n);
+			file.print(',');
+		}
+		// Many duplicate scores to check stability
+		file.print(int(n % 100) - 50);
+		file.print(".5\r\n");
+	}
+	return true;
+}
+
+String readFile(IFS::FileSystem& fs, const String& filename)
+{
+	FileStream file(&fs);
+	if(!file.open(filename, File::ReadOnly)) {
+		return nullptr;
+	}
+	return file.readString(file.available());
+}
+
+} // namespace
+
+class SortTest : public TestGroup
+{
+public:
+	SortTest() : TestGroup(_F("External sort"))
+	{
+	}
+
+	void verifyOrder(IFS::FileSystem& fs, const CSV::Parser::Options& options)
+	{
+		auto source = new FileStream(&fs);
+		REQUIRE(source->open(outputFile, File::ReadOnly));
+		CSV::Reader reader(source, options);
+		unsigned count{0};
+		double prevScore{-1000};
+		int prevId{-1};
+		unsigned idTotal{0};
+		while(reader.next()) {
+			auto score = atof(reader.getValue(col_score));
+			int id = atoi(reader.getValue(col_id));
+			CHECK(score >= prevScore);
+			if(score == prevScore) {
+				// Stable
+				CHECK(id > prevId);
+			}
+			prevScore = score;
+			prevId = id;
+			idTotal += id;
+			++count;
+		}
+		CHECK_EQ(count, recordCount);
+		CHECK_EQ(idTotal, recordCount * (recordCount - 1) / 2);
+	}
+
+	void execute() override
+	{
+		auto& fs = IFS::Host::getFileSystem();
+		REQUIRE(createInput(fs));
+		const String input = readFile(fs, inputFile);
+
+		const CSV::Parser::Options options{.commentChars = "#"};
+		CSV::ExternalSort::Settings settings{
+			.memoryLimit = 4096,
+			.threadCount = 4,
+			.numeric = true,
+			.fileSystem = &fs,
+		};
+
+		TEST_CASE("Numeric key, multiple threads")
+		{
+			CSV::ExternalSort sorter(options, settings);
+			REQUIRE(sorter.sort(inputFile, outputFile, col_score));
+			CHECK_EQ(sorter.getRecordCount(), recordCount);
+			CHECK(sorter.getRunCount() > 4);
+			Serial << _F("Sorted ") << sorter.getRecordCount() << _F(" records using ") << sorter.getRunCount()
+				   << _F(" runs") << endl;
+
+			String output = readFile(fs, outputFile);
+			CHECK_EQ(output.length(), input.length());
+			CHECK(output.startsWith(header));
+			// Quoting is preserved
+			CHECK(output.indexOf("\"Name, 5\nsecond line\"") > 0);
+		}
+
+		TEST_CASE("Verify order")
+		{
+			verifyOrder(fs, options);
+		}
+
+		TEST_CASE("Text key, single thread")
+		{
+			settings.threadCount = 1;
+			settings.numeric = false;
+			CSV::ExternalSort sorter(options, settings);
+			REQUIRE(sorter.sort(inputFile, outputFile, col_name));
+
+			auto source = new FileStream(&fs);
+			REQUIRE(source->open(outputFile, File::ReadOnly));
+			CSV::Reader reader(source, options);
+			unsigned count{0};
+			String prev;
+			while(reader.next()) {
+				String name = reader.getValue(col_name);
+				CHECK(strcmp(name.c_str(), prev.c_str()) >= 0);
+				prev = name;
+				++count;
+			}
+			CHECK_EQ(count, recordCount);
+		}
+
+		TEST_CASE("Multi-pass merge")
+		{
+			// Merge at most 3 runs at once
+			settings.memoryLimit = 2048;
+			settings.bufferSize = 512;
+			settings.numeric = true;
+			CSV::ExternalSort sorter(options, settings);
+			REQUIRE(sorter.sort(inputFile, outputFile, col_score));
+			Serial << _F("Merged ") << sorter.getRunCount() << _F(" runs in ") << sorter.getMergePassCount()
+				   << _F(" passes") << endl;
+			CHECK(sorter.getRunCount() > 9);
+			CHECK(sorter.getMergePassCount() > 2);
+			verifyOrder(fs, options);
+		}
+
+		TEST_CASE("Missing or truncated run")
+		{
+			CSV::ExternalSort sorter(options, settings);
+
+			// Records must not be silently lost
+			REQUIRE(sorter.createRuns(inputFile, col_score));
+			REQUIRE(sorter.getRunCount() > 2);
+			String runName = sorter.getRunName(1);
+			String run = readFile(fs, runName);
+			REQUIRE(run.length() > 3);
+			{
+				FileStream file(&fs);
+				REQUIRE(file.open(runName, File::CreateNewAlways | File::WriteOnly));
+				REQUIRE(file.write(reinterpret_cast<const uint8_t*>(run.c_str()), run.length() - 3) == run.length() - 3);
+			}
+			CHECK(!sorter.merge(outputFile));
+			FileStream file(&fs);
+			CHECK(!file.open(runName, File::ReadOnly));
+
+			REQUIRE(sorter.createRuns(inputFile, col_score));
+			fs.remove(sorter.getRunName(0).c_str());
+			CHECK(!sorter.merge(outputFile));
+
+			// Merge requires runs
+			CHECK(!sorter.merge(outputFile));
+		}
+
+		// Temporary files are removed
+		FileStream run(&fs);
+		CHECK(!run.open(String(outputFile) + ".0.tmp", File::ReadOnly));
+
+		fs.remove(String(inputFile).c_str());
+		fs.remove(String(outputFile).c_str());
+	}
+};
+
+#endif // ARCH_HOST
+
+void REGISTER_TEST(sort)
+{
+#ifdef ARCH_HOST
+	registerGroup<SortTest>();
+#endif
+}
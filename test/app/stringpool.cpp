@@ -0,0 +1,93 @@
+#include <SmingTest.h>
+#include <CSV/StringPool.h>
+
+class StringPoolTest : public TestGroup
+{
+public:
+	StringPoolTest() : TestGroup(_F("String pool test"))
+	{
+	}
+
+	void execute() override
+	{
+		TEST_CASE("Pool")
+		{
+			CSV::StringPool pool;
+			auto id1 = pool.add("Europe/London");
+			auto id2 = pool.add("GB");
+			auto id3 = pool.add("Europe/London");
+			auto id4 = pool.add("");
+			CHECK(id1 != pool.none);
+			CHECK(id1 != id2);
+			CHECK_EQ(id1, id3);
+			CHECK(id4 != pool.none);
+			CHECK_EQ(pool.count(), 3U);
+			CHECK_EQ(pool.add(nullptr), pool.none);
+			CHECK_EQ(pool.find("GB"), id2);
+			CHECK_EQ(pool.find("FR"), pool.none);
+			CHECK(F("Europe/London") == pool[id1]);
+			CHECK_EQ(pool.getLength(id1), 13U);
+			CHECK(pool[pool.none] == nullptr);
+
+			// Force table to grow
+			for(unsigned i = 0; i < 1000; ++i) {
+				String s(i);
+				pool.add(s.c_str(), s.length());
+			}
+			CHECK_EQ(pool.count(), 1003U);
+			CHECK_EQ(pool.find("GB"), id2);
+			CHECK(F("999") == pool[pool.find("999")]);
+		}
+
+		TEST_CASE("Intern zone1970.tab")
+		{
+			CSV::Reader reader(new FileStream(F("zone1970.tab")), CSV::Parser::Options{
+																	  .commentChars = "#",
+																	  .fieldSeparator = '\t',
+																  });
+			REQUIRE(reader);
+			CSV::InternTable table(reader.count());
+			auto recordCount = table.load(reader);
+			CHECK_EQ(recordCount, table.count());
+			auto& pool = table.getPool();
+			Serial << _F("Interned ") << recordCount << _F(" records, ") << pool.count() << _F(" strings, ")
+				   << pool.getUsed() << _F(" bytes") << endl;
+
+			// Verify content
+			reader.reset();
+			unsigned row{0};
+			unsigned mismatches{0};
+			while(reader.next()) {
+				for(unsigned col = 0; col < reader.count(); ++col) {
+					if(String(table.getValue(row, col) ?: "") != (reader.getValue(col) ?: "")) {
+						++mismatches;
+					}
+				}
+				++row;
+			}
+			CHECK_EQ(mismatches, 0U);
+
+			// Rebuild first row from source data
+			reader.reset();
+			REQUIRE(reader.next());
+			CStringArray expected;
+			for(unsigned col = 0; col < reader.count(); ++col) {
+				expected.add(reader.getValue(col) ?: "");
+			}
+			auto first = table.getRow(0);
+			CHECK_EQ(first.count(), expected.count());
+			CHECK(first == expected);
+
+			int london = table.find(2, "Europe/London");
+			REQUIRE(london >= 0);
+			CHECK(F("GB,GG,IM,JE") == table.getValue(london, 0));
+			CHECK_EQ(table.find(2, "Europe/Atlantis"), -1);
+			CHECK(table.getValue(table.count(), 0) == nullptr);
+		}
+	}
+};
+
+void REGISTER_TEST(stringpool)
+{
+	registerGroup<StringPoolTest>();
+}
@@ -0,0 +1,184 @@
+#include <SmingTest.h>
+#include <CSV/ZoneMap.h>
+#include <Data/Stream/MemoryDataStream.h>
+
+namespace
+{
+constexpr unsigned recordCount{1000};
+constexpr unsigned blockSize{50};
+constexpr unsigned baseTime{1600000000};
+
+enum Column {
+	col_time,
+	col_level,
+	col_message,
+};
+
+/*
+ * Log data with mostly ascending timestamps
+ */
+IDataSourceStream* createLog()
+{
+	static const char* levels[]{"INFO", "WARN", "ERROR", "DEBUG"};
+	auto stream = new MemoryDataStream;
+	stream->print("time,level,message\n");
+	for(unsigned i = 0; i < recordCount; ++i) {
+		// Some records are slightly out of order
+		unsigned time = baseTime + i * 10 + ((i % 7 == 3) ? 15 : 0);
+		stream->print(time);
+		stream->print(',');
+		stream->print(levels[(i * 5 + i / 3) % 4]);
+		stream->print(",\"Message ");
+		stream->print(i);
+		stream->print("\"\n");
+	}
+	return stream;
+}
+
+/*
+ * Count matching records by reading everything
+ */
+unsigned bruteForce(CSV::Reader& reader, unsigned column, const char* min, const char* max, bool numeric)
+{
+	unsigned count{0};
+	reader.reset();
+	while(reader.next()) {
+		auto value = reader.getValue(column);
+		if(numeric) {
+			auto n = atof(value);
+			count += (n >= atof(min) && n <= atof(max));
+		} else {
+			count += (strcmp(value, min) >= 0 && strcmp(value, max) <= 0);
+		}
+	}
+	return count;
+}
+
+} // namespace
+
+class ZoneMapTest : public TestGroup
+{
+public:
+	ZoneMapTest() : TestGroup(_F("Zone map"))
+	{
+	}
+
+	void execute() override
+	{
+		CSV::Reader reader(createLog());
+		REQUIRE(reader);
+
+		CSV::ZoneMap map;
+		map.build(reader, {col_time, col_level}, blockSize);
+		REQUIRE_EQ(map.count(), recordCount / blockSize);
+		CHECK_EQ(map[0].count, blockSize);
+		CHECK(map.getSummary(0, col_time).numeric);
+		CHECK(!map.getSummary(0, col_level).numeric);
+		CHECK_EQ(map.getSummary(0, col_time).min, double(baseTime));
+
+		auto checkScan = [&](const CSV::ZoneMap& map, const char* min, const char* max) {
+			int prev{-1};
+			unsigned count = map.scan(reader, col_time, min, max, [&](CSV::Reader& reader) {
+				// Results are in source order
+				CHECK(reader.tell() > prev);
+				prev = reader.tell();
+				return true;
+			});
+			CHECK_EQ(count, bruteForce(reader, col_time, min, max, true));
+			return count;
+		};
+
+		TEST_CASE("Numeric range")
+		{
+			String min(baseTime + 2000);
+			String max(baseTime + 3000);
+			CHECK(checkScan(map, min.c_str(), max.c_str()) >= 100U);
+
+			// Only a few blocks need to be read
+			unsigned candidates{0};
+			for(unsigned i = 0; i < map.count(); ++i) {
+				candidates += map.mayContain(i, col_time, min.c_str(), max.c_str());
+			}
+			CHECK(candidates <= 4);
+
+			// Nothing outside data range
+			String late(baseTime + 100000);
+			CHECK_EQ(map.scan(reader, col_time, late.c_str(), nullptr, nullptr), 0U);
+			for(unsigned i = 0; i < map.count(); ++i) {
+				CHECK(!map.mayContain(i, col_time, late.c_str(), nullptr));
+			}
+		}
+
+		TEST_CASE("Text range")
+		{
+			unsigned count = map.scan(reader, col_level, "ERROR", "ERROR", nullptr);
+			CHECK(count > 0);
+			CHECK_EQ(count, bruteForce(reader, col_level, "ERROR", "ERROR", false));
+			CHECK_EQ(map.scan(reader, col_level, "X", nullptr, nullptr), 0U);
+			CHECK_EQ(map.scan(reader, col_level, nullptr, nullptr, nullptr), recordCount);
+		}
+
+		TEST_CASE("Build during scan")
+		{
+			CSV::ZoneMap map2;
+			map2.begin({col_time}, blockSize);
+			reader.reset();
+			while(reader.next()) {
+				map2.add(reader.getCursor(), reader.getRow());
+			}
+			map2.end();
+			REQUIRE_EQ(map2.count(), map.count());
+			for(unsigned i = 0; i < map.count(); ++i) {
+				CHECK_EQ(map2[i].start, map[i].start);
+				CHECK_EQ(map2[i].end, map[i].end);
+				CHECK_EQ(map2.getSummary(i, col_time).max, map.getSummary(i, col_time).max);
+			}
+		}
+
+		TEST_CASE("Save and load")
+		{
+			MemoryDataStream stream;
+			REQUIRE(map.save(stream));
+			CSV::ZoneMap map2;
+			REQUIRE(map2.load(stream));
+			REQUIRE_EQ(map2.count(), map.count());
+			CHECK(map2.getColumns() == map.getColumns());
+			CHECK(map2.getSummary(3, col_level).maxText == map.getSummary(3, col_level).maxText);
+			checkScan(map2, String(baseTime + 5000).c_str(), String(baseTime + 5500).c_str());
+		}
+
+		TEST_CASE("Invalid data")
+		{
+			CHECK(!map.getSummary(0, 99).minText);
+			CHECK(!map.getSummary(map.count(), col_time).minText);
+
+			MemoryDataStream stream;
+			REQUIRE(map.save(stream));
+			size_t length = stream.available();
+			String data;
+			REQUIRE(data.setLength(length));
+			REQUIRE_EQ(stream.readBytes(data.begin(), length), length);
+
+			// Truncated
+			CSV::ZoneMap map2;
+			MemoryDataStream truncated;
+			truncated.write(reinterpret_cast<const uint8_t*>(data.c_str()), length - 1);
+			CHECK(!map2.load(truncated));
+			CHECK_EQ(map2.count(), 0U);
+
+			// Block count exceeds data
+			auto hdr = data;
+			uint32_t blockCount{0x40000000};
+			memcpy(hdr.begin() + 8, &blockCount, sizeof(blockCount));
+			MemoryDataStream corrupt;
+			corrupt.write(reinterpret_cast<const uint8_t*>(hdr.c_str()), length);
+			CHECK(!map2.load(corrupt));
+			CHECK_EQ(map2.count(), 0U);
+		}
+	}
+};
+
+void REGISTER_TEST(zonemap)
+{
+	registerGroup<ZoneMapTest>();
+}
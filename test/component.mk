@@ -10,3 +10,23 @@ DISABLE_NETWORK := 1
 
 .PHONY: execute
 execute: flash run
+
+# Set to 1 to run differential test as a libFuzzer target
+# Host only, requires CLANG_BUILD=1
+CONFIG_VARS += CSV_FUZZ
+CSV_FUZZ ?= 0
+APP_CFLAGS += -DCSV_FUZZ=$(CSV_FUZZ)
+ifeq ($(CSV_FUZZ),1)
+# Application provides main() so link runtime without it, matching host build architecture
+ifeq ($(BUILD64),1)
+CSV_FUZZ_ARCH := x86_64
+else
+CSV_FUZZ_ARCH := i386
+endif
+CSV_FUZZ_LIB := $(shell clang -print-file-name=libclang_rt.fuzzer_no_main-$(CSV_FUZZ_ARCH).a)
+ifeq (,$(wildcard $(CSV_FUZZ_LIB)))
+$(error libFuzzer runtime '$(CSV_FUZZ_LIB)' not found)
+endif
+GLOBAL_CFLAGS += -fsanitize=fuzzer-no-link,address
+EXTRA_LDFLAGS += -fsanitize=fuzzer-no-link,address $(CSV_FUZZ_LIB)
+endif
@@ -0,0 +1,70 @@
+// Generated by CSV::CodeGenerator, do not edit
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+namespace Test::Stock
+{
+struct Record {
+	int32_t id;
+	const char* name;
+	double price;
+	int32_t stock;
+	const char* barcode;
+};
+
+constexpr const char* columnNames[]{
+	"id",
+	"name",
+	"price",
+	"stock",
+	"barcode",
+};
+
+constexpr Record records[]{
+	{1, "Widget", 2.5, 10, "5012345678900"},
+	{2, "Gadget, \"deluxe\"", 12.0, 0, ""},
+	{3, "Sprocket", 0.75, 1234, "0400638133393"},
+	{4, "Left\\Right", -1000.0, -7, "9780201379624"},
+};
+
+constexpr size_t recordCount{sizeof(records) / sizeof(records[0])};
+
+/**
+ * @brief Find first record with a matching value
+ * @retval const Record* nullptr if not found
+ */
+template <typename T, typename V> constexpr const Record* find(T Record::*field, const V& value)
+{
+	for(auto& rec : records) {
+		if(rec.*field == value) {
+			return &rec;
+		}
+	}
+	return nullptr;
+}
+
+constexpr const Record* findById(int32_t value)
+{
+	return find(&Record::id, value);
+}
+
+constexpr const Record* findByName(std::string_view value)
+{
+	return find(&Record::name, value);
+}
+
+constexpr const Record* findByStock(int32_t value)
+{
+	return find(&Record::stock, value);
+}
+
+constexpr const Record* findByBarcode(std::string_view value)
+{
+	return find(&Record::barcode, value);
+}
+
+} // namespace Test::Stock
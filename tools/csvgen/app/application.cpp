@@ -0,0 +1,146 @@
+#include <SmingCore.h>
+#include <hostlib/CommandLine.h>
+#include <IFS/Host/FileSystem.h>
+#include <CSV/CodeGenerator.h>
+#include <CSV/FlashTable.h>
+#include <CSV/ColumnFile.h>
+
+namespace
+{
+struct Settings {
+	String source;
+	String output;
+	String mode{"header"};
+	String name{"CsvData"};
+	String commentChars;
+	CStringArray headings;
+	std::vector<CSV::ValueType> types;
+	CSV::Parser::Options options;
+};
+
+CStringArray split(String value)
+{
+	value.replace(',', '\0');
+	return CStringArray(std::move(value));
+}
+
+bool parseSeparator(const String& value, char& separator)
+{
+	if(value == "tab") {
+		separator = '\t';
+	} else if(value == "space") {
+		separator = '\0';
+	} else if(value.length() == 1) {
+		separator = value[0];
+	} else {
+		return false;
+	}
+	return true;
+}
+
+bool parseTypes(const String& value, std::vector<CSV::ValueType>& types)
+{
+	for(auto name : split(value)) {
+		if(F("auto") == name) {
+			types.push_back(CSV::ValueType::empty);
+		} else if(F("text") == name) {
+			types.push_back(CSV::ValueType::text);
+		} else if(F("integer") == name) {
+			types.push_back(CSV::ValueType::integer);
+		} else if(F("number") == name) {
+			types.push_back(CSV::ValueType::number);
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool parseParameters(Settings& settings)
+{
+	for(auto& param : commandLine.getParameters()) {
+		String name = param.getName();
+		String value = param.getValue();
+		bool ok{true};
+		if(name == "source") {
+			settings.source = value;
+		} else if(name == "output") {
+			settings.output = value;
+		} else if(name == "mode") {
+			settings.mode = value;
+			ok = (value == "header" || value == "table" || value == "columns");
+		} else if(name == "name") {
+			settings.name = value;
+		} else if(name == "separator") {
+			ok = parseSeparator(value, settings.options.fieldSeparator);
+		} else if(name == "comment") {
+			settings.commentChars = value;
+		} else if(name == "headings") {
+			settings.headings = split(value);
+		} else if(name == "types") {
+			ok = parseTypes(value, settings.types);
+		} else {
+			ok = false;
+		}
+		if(!ok) {
+			Serial << _F("Invalid parameter '") << param.text << '\'' << endl;
+			return false;
+		}
+	}
+
+	if(!settings.source || !settings.output) {
+		Serial << _F("Usage: source=FILE output=FILE [mode=header|table|columns] [name=NAMESPACE] "
+					 "[separator=CHAR|tab|space] [comment=CHARS] [headings=NAME,...] "
+					 "[types=auto|text|integer|number,...]")
+			   << endl;
+		return false;
+	}
+
+	if(settings.commentChars) {
+		settings.options.commentChars = settings.commentChars.c_str();
+	}
+	return true;
+}
+
+bool generate(const Settings& settings)
+{
+	auto& fs = IFS::Host::getFileSystem();
+	auto source = new FileStream(&fs);
+	if(!source->open(settings.source, File::ReadOnly)) {
+		Serial << _F("Failed to open '") << settings.source << _F("': ") << source->getLastErrorString() << endl;
+		delete source;
+		return false;
+	}
+	CSV::Reader reader(source, settings.options, settings.headings);
+
+	FileStream output(&fs);
+	if(!output.open(settings.output, File::CreateNewAlways | File::WriteOnly)) {
+		Serial << _F("Failed to create '") << settings.output << _F("': ") << output.getLastErrorString() << endl;
+		return false;
+	}
+
+	bool ok;
+	if(settings.mode == "table") {
+		ok = CSV::FlashTable::build(reader, output);
+	} else if(settings.mode == "columns") {
+		ok = CSV::ColumnFile::build(reader, output);
+	} else {
+		CSV::CodeGenerator generator(reader, settings.types);
+		ok = generator.generate(output, settings.name.c_str());
+	}
+	output.close();
+	if(!ok) {
+		Serial << _F("Failed to generate '") << settings.output << '\'' << endl;
+		fs.remove(settings.output.c_str());
+	}
+	return ok;
+}
+
+} // namespace
+
+void init()
+{
+	Settings settings;
+	bool ok = parseParameters(settings) && generate(settings);
+	exit(ok ? 0 : 1);
+}
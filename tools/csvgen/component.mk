@@ -0,0 +1,3 @@
+COMPONENT_DEPENDS := CsvReader
+DISABLE_NETWORK := 1
+HOST_NETWORK_OPTIONS := --nonet